@@ -4,14 +4,23 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../DecomposicaoEspacial.cpp \
+../GravadorAssincrono.cpp \
+../LimiteInferior.cpp \
 ../TSPsolver.cpp \
 ../main.cpp 
 
 OBJS += \
+./DecomposicaoEspacial.o \
+./GravadorAssincrono.o \
+./LimiteInferior.o \
 ./TSPsolver.o \
 ./main.o 
 
 CPP_DEPS += \
+./DecomposicaoEspacial.d \
+./GravadorAssincrono.d \
+./LimiteInferior.d \
 ./TSPsolver.d \
 ./main.d 
 
@@ -0,0 +1,303 @@
+/*
+ * DecomposicaoEspacial.cpp
+ *
+ *  Decomposição espacial da rota em regiões otimizadas em paralelo.
+ */
+
+#include "DecomposicaoEspacial.h"
+#include "TSPsolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+const int NumIteracoesKMeans = 5;
+const uint32_t LadoGradeHilbert = 1 << 16;
+
+// posição do ponto (x, y) na curva de Hilbert que cobre uma grade lado x lado
+uint64_t indiceHilbert(uint32_t lado, uint32_t x, uint32_t y) {
+	uint64_t d = 0;
+	for (uint32_t s = lado / 2; s > 0; s /= 2) {
+		uint32_t rx = (x & s) > 0;
+		uint32_t ry = (y & s) > 0;
+		d += (uint64_t) s * s * ((3 * rx) ^ ry);
+		if (ry == 0) {
+			if (rx == 1) {
+				x = lado - 1 - x;
+				y = lado - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+}
+
+DecomposicaoEspacial::DecomposicaoEspacial(int nv, double** coord, double lambda, int iteracoes, int opcao,
+		uint64_t semente) {
+	this->numVertices = nv;
+	this->coord = new double*[nv];
+	for (int i = 0; i < nv; i++) {
+		this->coord[i] = new double[2];
+		this->coord[i][0] = coord[i][0];
+		this->coord[i][1] = coord[i][1];
+	}
+	this->lambda = lambda;
+	this->iteracoes = iteracoes;
+	this->opcao = opcao;
+	this->tamanhoRegiao = TSPsolverOpcao::TamanhoRegiaoDecomposicao;
+	this->numThreads = std::max(1, (int) std::thread::hardware_concurrency());
+	this->verboso = true;
+	this->gerador.semear(semente);
+}
+
+DecomposicaoEspacial::~DecomposicaoEspacial() {
+	for (int i = 0; i < this->numVertices; i++)
+		delete[] this->coord[i];
+	delete[] this->coord;
+}
+
+void DecomposicaoEspacial::definirTamanhoRegiao(int tamanhoRegiao) {
+	this->tamanhoRegiao = std::max(TSPsolverOpcao::TamanhoMinimoTrechoDecomposicao, tamanhoRegiao);
+}
+
+void DecomposicaoEspacial::definirNumThreads(int numThreads) {
+	this->numThreads = std::max(1, numThreads);
+}
+
+void DecomposicaoEspacial::definirVerbosidade(bool verboso) {
+	this->verboso = verboso;
+}
+
+double DecomposicaoEspacial::distancia(int i, int j) {
+	return sqrt(pow(this->coord[j][0] - this->coord[i][0], 2) + pow(this->coord[j][1] - this->coord[i][1], 2));
+}
+
+double DecomposicaoEspacial::custoRota(int* rota) {
+	double soma = 0;
+	for (int i = 0; i < this->numVertices; i++)
+		soma += this->distancia(rota[i], rota[(i + 1) % this->numVertices]);
+	return soma;
+}
+
+// rota inicial espacialmente coerente: cidades na ordem da curva de Hilbert
+int* DecomposicaoEspacial::gerarRotaCurvaHilbert() {
+	int n = this->numVertices;
+	double minX = DBL_MAX, minY = DBL_MAX, maxX = -DBL_MAX, maxY = -DBL_MAX;
+	for (int i = 0; i < n; i++) {
+		minX = std::min(minX, this->coord[i][0]);
+		maxX = std::max(maxX, this->coord[i][0]);
+		minY = std::min(minY, this->coord[i][1]);
+		maxY = std::max(maxY, this->coord[i][1]);
+	}
+	double escala = (LadoGradeHilbert - 1) / std::max(std::max(maxX - minX, maxY - minY), 1e-12);
+	std::vector<std::pair<uint64_t, int> > indices(n);
+	for (int i = 0; i < n; i++) {
+		uint32_t x = (uint32_t) ((this->coord[i][0] - minX) * escala);
+		uint32_t y = (uint32_t) ((this->coord[i][1] - minY) * escala);
+		indices[i] = std::make_pair(indiceHilbert(LadoGradeHilbert, x, y), i);
+	}
+	std::sort(indices.begin(), indices.end());
+	int* rota = new int[n];
+	for (int i = 0; i < n; i++)
+		rota[i] = indices[i].second;
+	return rota;
+}
+
+// k-means (Lloyd) com centros iniciais sorteados a cada chamada
+void DecomposicaoEspacial::particionarKMeans(int* regiao) {
+	int n = this->numVertices;
+	int k = std::max(1, (n + this->tamanhoRegiao - 1) / this->tamanhoRegiao);
+	std::vector<double> cx(k), cy(k), somaX(k), somaY(k);
+	std::vector<int> cont(k);
+	for (int c = 0; c < k; c++) {
+		int cidade = this->gerador.inteiro(n);
+		cx[c] = this->coord[cidade][0];
+		cy[c] = this->coord[cidade][1];
+	}
+	for (int it = 0; it < NumIteracoesKMeans; it++) {
+		std::fill(somaX.begin(), somaX.end(), 0);
+		std::fill(somaY.begin(), somaY.end(), 0);
+		std::fill(cont.begin(), cont.end(), 0);
+		for (int i = 0; i < n; i++) {
+			int melhor = 0;
+			double melhorDist = DBL_MAX;
+			for (int c = 0; c < k; c++) {
+				double dx = this->coord[i][0] - cx[c];
+				double dy = this->coord[i][1] - cy[c];
+				double d = dx * dx + dy * dy;
+				if (d < melhorDist) {
+					melhorDist = d;
+					melhor = c;
+				}
+			}
+			regiao[i] = melhor;
+			somaX[melhor] += this->coord[i][0];
+			somaY[melhor] += this->coord[i][1];
+			cont[melhor]++;
+		}
+		for (int c = 0; c < k; c++) {
+			if (cont[c] > 0) {
+				cx[c] = somaX[c] / cont[c];
+				cy[c] = somaY[c] / cont[c];
+			}
+		}
+	}
+}
+
+// trechos maximais de posições consecutivas da rota com cidades da mesma região
+void DecomposicaoEspacial::encontrarTrechos(int* rota, int* regiao, std::vector<Trecho>* trechos) {
+	int n = this->numVertices;
+	trechos->clear();
+	int inicio = 0;
+	for (int i = 1; i < n; i++) {
+		if (regiao[rota[i]] != regiao[rota[i - 1]]) {
+			inicio = i;
+			break;
+		}
+	}
+	Trecho trecho;
+	trecho.inicio = inicio;
+	trecho.tamanho = 1;
+	for (int k = 1; k < n; k++) {
+		int pos = (inicio + k) % n;
+		if (regiao[rota[pos]] == regiao[rota[trecho.inicio]]) {
+			trecho.tamanho++;
+		} else {
+			if (trecho.tamanho >= TSPsolverOpcao::TamanhoMinimoTrechoDecomposicao)
+				trechos->push_back(trecho);
+			trecho.inicio = pos;
+			trecho.tamanho = 1;
+		}
+	}
+	if (trecho.tamanho >= TSPsolverOpcao::TamanhoMinimoTrechoDecomposicao)
+		trechos->push_back(trecho);
+}
+
+// otimiza o caminho rota[inicio .. inicio + tamanho - 1] mantendo as duas
+// extremidades: no subproblema a aresta entre elas recebe peso muito negativo,
+// então nenhuma busca local a remove e a rota do subproblema é o caminho
+// fechado por ela. Um trecho que cobre a rota inteira (uma única região) é
+// otimizado como rota fechada, sem aresta fixa
+bool DecomposicaoEspacial::otimizarTrecho(int* rota, Trecho trecho, uint64_t semente) {
+	int n = this->numVertices;
+	int m = trecho.tamanho;
+	bool fechado = (m == n);
+	std::vector<int> cidades(m);
+	for (int k = 0; k < m; k++)
+		cidades[k] = rota[(trecho.inicio + k) % n];
+
+	double custoOriginal = 0;
+	for (int k = 0; k < m - 1; k++)
+		custoOriginal += this->distancia(cidades[k], cidades[k + 1]);
+	if (fechado)
+		custoOriginal += this->distancia(cidades[m - 1], cidades[0]);
+
+	double** subPesos = new double*[m];
+	for (int i = 0; i < m; i++) {
+		subPesos[i] = new double[m];
+		for (int j = i + 1; j < m; j++)
+			subPesos[i][j] = this->distancia(cidades[i], cidades[j]);
+	}
+	if (!fechado)
+		subPesos[0][m - 1] = -1000 * (custoOriginal + 1);
+
+	double lambdaTrecho = (this->lambda > 0 ? this->lambda : 0.3 * custoOriginal / m);
+	TSPsolver* solver = new TSPsolver(m, subPesos, lambdaTrecho, this->iteracoes, this->opcao, semente);
+	for (int i = 0; i < m; i++)
+		delete[] subPesos[i];
+	delete[] subPesos;
+	solver->definirVerbosidade(false);
+
+	int* ordem = new int[m];
+	for (int k = 0; k < m; k++)
+		ordem[k] = k;
+	solver->definirSolucaoInicial(ordem);
+	int* resultado = solver->resolver();
+	delete solver;
+
+	if (fechado) {
+		std::copy(resultado, resultado + m, ordem);
+	} else {
+		// percorrer a rota do subproblema de 0 até m - 1 sem usar a aresta fixa
+		int pos0 = 0;
+		while (resultado[pos0] != 0)
+			pos0++;
+		int passo = (resultado[(pos0 + 1) % m] == m - 1 ? -1 : 1);
+		for (int k = 0; k < m; k++)
+			ordem[k] = resultado[((pos0 + passo * k) % m + m) % m];
+	}
+	delete[] resultado;
+
+	bool melhorou = false;
+	if (fechado || ordem[m - 1] == m - 1) {
+		double custoNovo = 0;
+		for (int k = 0; k < m - 1; k++)
+			custoNovo += this->distancia(cidades[ordem[k]], cidades[ordem[k + 1]]);
+		if (fechado)
+			custoNovo += this->distancia(cidades[ordem[m - 1]], cidades[ordem[0]]);
+		if (custoNovo < custoOriginal - 1e-9) {
+			for (int k = 0; k < m; k++)
+				rota[(trecho.inicio + k) % n] = cidades[ordem[k]];
+			melhorou = true;
+		}
+	}
+	delete[] ordem;
+	return melhorou;
+}
+
+int* DecomposicaoEspacial::resolver(int rodadas, int* rotaInicial) {
+	int n = this->numVertices;
+	int* rota;
+	if (rotaInicial == NULL) {
+		rota = this->gerarRotaCurvaHilbert();
+	} else {
+		rota = new int[n];
+		std::copy(rotaInicial, rotaInicial + n, rota);
+	}
+	if (this->verboso)
+		std::printf("Rota inicial: custo %.1f\n", this->custoRota(rota));
+
+	int* regiao = new int[n];
+	std::vector<Trecho> trechos;
+	std::vector<uint64_t> sementes;
+	for (int r = 0; r < rodadas; r++) {
+		this->particionarKMeans(regiao);
+		this->encontrarTrechos(rota, regiao, &trechos);
+
+		// sementes sorteadas antes de distribuir os trechos: o resultado não
+		// depende do número de threads nem da ordem em que terminam
+		sementes.resize(trechos.size());
+		for (unsigned int t = 0; t < trechos.size(); t++)
+			sementes[t] = this->gerador.proximo();
+
+		// os trechos são disjuntos, então cada thread escreve só nas suas posições
+		std::atomic<int> proximo(0);
+		std::atomic<int> melhorados(0);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < this->numThreads; t++) {
+			threads.push_back(std::thread([&]() {
+				int ind;
+				while ((ind = proximo++) < (int) trechos.size()) {
+					if (this->otimizarTrecho(rota, trechos[ind], sementes[ind]))
+						melhorados++;
+				}
+			}));
+		}
+		for (unsigned int t = 0; t < threads.size(); t++)
+			threads[t].join();
+
+		if (this->verboso)
+			std::printf("Rodada %d: %d trechos, %d melhorados, custo %.1f\n", r, (int) trechos.size(),
+					melhorados.load(), this->custoRota(rota));
+	}
+
+	delete[] regiao;
+	return rota;
+}
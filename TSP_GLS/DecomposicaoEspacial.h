@@ -0,0 +1,55 @@
+/*
+ * DecomposicaoEspacial.h
+ *
+ *  Otimização de instâncias grandes com coordenadas por decomposição espacial.
+ *  A cada rodada as cidades são agrupadas por k-means (com sementes novas, de
+ *  modo que as fronteiras mudam de uma rodada para outra) e a rota atual é
+ *  quebrada nos trechos contíguos que ficam dentro de uma mesma região. Cada
+ *  trecho é otimizado como um caminho com extremidades fixas por um TSPsolver
+ *  próprio, em threads separadas, e escrito de volta no lugar se melhorar.
+ *
+ *  Só usa as coordenadas: nenhuma matriz N x N é alocada, apenas as matrizes
+ *  dos trechos.
+ */
+
+#ifndef DECOMPOSICAOESPACIAL_H_
+#define DECOMPOSICAOESPACIAL_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "GeradorAleatorio.h"
+
+class DecomposicaoEspacial {
+private:
+	int numVertices;
+	double** coord;
+	double lambda;
+	int iteracoes;
+	int opcao;
+	int tamanhoRegiao;
+	int numThreads;
+	bool verboso;
+	GeradorAleatorio gerador;
+
+	struct Trecho {
+		int inicio;
+		int tamanho;
+	};
+
+	double distancia(int i, int j);
+	int* gerarRotaCurvaHilbert();
+	void particionarKMeans(int* regiao);
+	void encontrarTrechos(int* rota, int* regiao, std::vector<Trecho>* trechos);
+	bool otimizarTrecho(int* rota, Trecho trecho, uint64_t semente);
+public:
+	DecomposicaoEspacial(int nv, double** coord, double lambda, int iteracoes, int opcao, uint64_t semente);
+	int* resolver(int rodadas, int* rotaInicial);
+	double custoRota(int* rota);
+	void definirTamanhoRegiao(int tamanhoRegiao);
+	void definirNumThreads(int numThreads);
+	void definirVerbosidade(bool verboso);
+	virtual ~DecomposicaoEspacial();
+};
+
+#endif /* DECOMPOSICAOESPACIAL_H_ */
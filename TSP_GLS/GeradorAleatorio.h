@@ -0,0 +1,80 @@
+/*
+ * GeradorAleatorio.h
+ *
+ *  Gerador pseudoaleatório xoshiro256** (Blackman e Vigna), semeado por
+ *  splitmix64. Cada solver tem o seu, então execuções com a mesma semente são
+ *  reprodutíveis e solvers em threads diferentes não compartilham estado.
+ */
+
+#ifndef GERADORALEATORIO_H_
+#define GERADORALEATORIO_H_
+
+#include <stdint.h>
+
+class GeradorAleatorio {
+private:
+	uint64_t estado[4];
+
+	static uint64_t rotacionar(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+public:
+	GeradorAleatorio(uint64_t semente = 0) {
+		this->semear(semente);
+	}
+
+	void semear(uint64_t semente) {
+		// splitmix64 para espalhar a semente pelos 256 bits de estado
+		for (int i = 0; i < 4; i++) {
+			semente += 0x9E3779B97F4A7C15ULL;
+			uint64_t z = semente;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			this->estado[i] = z ^ (z >> 31);
+		}
+	}
+
+	// estado completo, para salvar e retomar a sequência (checkpoint)
+	void obterEstado(uint64_t* estado) {
+		for (int i = 0; i < 4; i++)
+			estado[i] = this->estado[i];
+	}
+
+	void definirEstado(const uint64_t* estado) {
+		for (int i = 0; i < 4; i++)
+			this->estado[i] = estado[i];
+	}
+
+	// finalizador do splitmix64: valor pseudoaleatório calculado direto de um
+	// contador, sem estado (permite refazer exatamente um sorteio)
+	static uint64_t misturar(uint64_t x) {
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	uint64_t proximo() {
+		uint64_t resultado = rotacionar(this->estado[1] * 5, 7) * 9;
+		uint64_t t = this->estado[1] << 17;
+		this->estado[2] ^= this->estado[0];
+		this->estado[3] ^= this->estado[1];
+		this->estado[1] ^= this->estado[2];
+		this->estado[0] ^= this->estado[3];
+		this->estado[2] ^= t;
+		this->estado[3] = rotacionar(this->estado[3], 45);
+		return resultado;
+	}
+
+	// inteiro em [0, limite), por multiplicação (sem divisão)
+	int inteiro(int limite) {
+		return (int) (((this->proximo() >> 32) * (uint64_t) limite) >> 32);
+	}
+
+	// real em [0, 1)
+	double uniforme() {
+		return (this->proximo() >> 11) * (1.0 / 9007199254740992.0);
+	}
+};
+
+#endif /* GERADORALEATORIO_H_ */
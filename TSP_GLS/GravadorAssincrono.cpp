@@ -0,0 +1,44 @@
+/*
+ * GravadorAssincrono.cpp
+ *
+ *  Gravação de checkpoints em segundo plano.
+ */
+
+#include "GravadorAssincrono.h"
+
+#include <cstdio>
+#include <unistd.h>
+
+GravadorAssincrono::~GravadorAssincrono() {
+	this->aguardar();
+}
+
+// assume os dados (o vetor do chamador fica vazio) e inicia a gravação;
+// espera antes a gravação anterior, se ainda não terminou
+void GravadorAssincrono::gravar(const std::string& arquivo, std::vector<char>* dados) {
+	this->aguardar();
+	this->arquivo = arquivo;
+	this->dados.swap(*dados);
+	dados->clear();
+	this->thread = std::thread(&GravadorAssincrono::escrever, this);
+}
+
+void GravadorAssincrono::aguardar() {
+	if (this->thread.joinable())
+		this->thread.join();
+}
+
+void GravadorAssincrono::escrever() {
+	std::string temporario = this->arquivo + ".tmp";
+	FILE* arq = std::fopen(temporario.c_str(), "wb");
+	if (arq == NULL) {
+		std::fprintf(stderr, "Erro ao criar arquivo de checkpoint %s.\n", temporario.c_str());
+		return;
+	}
+	bool ok = std::fwrite(this->dados.data(), 1, this->dados.size(), arq) == this->dados.size();
+	ok = (std::fflush(arq) == 0) && ok;
+	ok = (fsync(fileno(arq)) == 0) && ok;
+	ok = (std::fclose(arq) == 0) && ok;
+	if (!ok || std::rename(temporario.c_str(), this->arquivo.c_str()) != 0)
+		std::fprintf(stderr, "Erro ao gravar arquivo de checkpoint %s.\n", this->arquivo.c_str());
+}
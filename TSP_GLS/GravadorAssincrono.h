@@ -0,0 +1,30 @@
+/*
+ * GravadorAssincrono.h
+ *
+ *  Grava um bloco de bytes em arquivo numa thread separada, para que a busca
+ *  não pare enquanto o checkpoint vai para o disco. A gravação é feita num
+ *  arquivo temporário renomeado ao final, então o arquivo de destino tem sempre
+ *  um checkpoint completo. Só há uma gravação em andamento por vez.
+ */
+
+#ifndef GRAVADORASSINCRONO_H_
+#define GRAVADORASSINCRONO_H_
+
+#include <string>
+#include <thread>
+#include <vector>
+
+class GravadorAssincrono {
+private:
+	std::thread thread;
+	std::vector<char> dados;
+	std::string arquivo;
+
+	void escrever();
+public:
+	void gravar(const std::string& arquivo, std::vector<char>* dados);
+	void aguardar();
+	virtual ~GravadorAssincrono();
+};
+
+#endif /* GRAVADORASSINCRONO_H_ */
@@ -0,0 +1,341 @@
+/*
+ * LimiteInferior.cpp
+ *
+ *  Limite inferior de Held-Karp por 1-árvore e subgradiente.
+ */
+
+#include "LimiteInferior.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+
+const int IteracoesEntreArvoresDensas = 100;
+
+// ordena candidatos por alfa e, no empate, por peso
+struct ComparaAlfa {
+	const std::vector<double>* alfa;
+	const std::vector<double>* peso;
+	bool operator()(int a, int b) const {
+		if ((*alfa)[a] != (*alfa)[b])
+			return (*alfa)[a] < (*alfa)[b];
+		return (*peso)[a] < (*peso)[b];
+	}
+};
+
+}
+
+LimiteInferior::LimiteInferior(int nv, double** pesos, int numCandidatos) {
+	this->numVertices = nv;
+	this->pesos = pesos;
+	this->pi = new double[nv]();
+	this->pai = new int[nv];
+	this->ordemInsercao = new int[nv];
+	this->limite = 0;
+	this->calculado = false;
+	this->especial1 = -1;
+	this->especial2 = -1;
+
+	// grafo de candidatos: k vizinhos mais próximos, simetrizado
+	int k = std::min(numCandidatos, nv - 1);
+	this->candidatos.resize(nv);
+	std::vector<std::pair<double, int> > vizinhos;
+	for (int i = 0; i < nv; i++) {
+		vizinhos.clear();
+		for (int j = 0; j < nv; j++)
+			if (j != i)
+				vizinhos.push_back(std::make_pair(this->peso(i, j), j));
+		if (k <= 0)
+			continue;
+		std::nth_element(vizinhos.begin(), vizinhos.begin() + (k - 1), vizinhos.end());
+		for (int c = 0; c < k; c++) {
+			int j = vizinhos[c].second;
+			this->candidatos[i].push_back(j);
+			this->candidatos[j].push_back(i);
+		}
+	}
+	for (int i = 0; i < nv; i++) {
+		std::sort(this->candidatos[i].begin(), this->candidatos[i].end());
+		this->candidatos[i].erase(std::unique(this->candidatos[i].begin(), this->candidatos[i].end()),
+				this->candidatos[i].end());
+	}
+	// mais as arestas da árvore geradora mínima com pi = 0: o grafo de candidatos
+	// fica conexo (instâncias agrupadas desconectam os k vizinhos)
+	if (nv >= 3) {
+		this->arvoreGeradoraDensa(this->pi);
+		this->acrescentarArestasArvore();
+	}
+}
+
+// inclui no grafo de candidatos as arestas da árvore em pai que faltam
+void LimiteInferior::acrescentarArestasArvore() {
+	for (int v = 2; v < this->numVertices; v++) {
+		int u = this->pai[v];
+		if (std::find(this->candidatos[v].begin(), this->candidatos[v].end(), u) == this->candidatos[v].end()) {
+			this->candidatos[v].push_back(u);
+			this->candidatos[u].push_back(v);
+		}
+	}
+}
+
+LimiteInferior::~LimiteInferior() {
+	delete[] this->pi;
+	delete[] this->pai;
+	delete[] this->ordemInsercao;
+}
+
+double LimiteInferior::peso(int i, int j) {
+	return this->pesos[std::min(i, j)][std::max(i, j)];
+}
+
+double LimiteInferior::pesoModificado(int i, int j, double* pi) {
+	return this->peso(i, j) + pi[i] + pi[j];
+}
+
+// árvore geradora mínima densa (Prim, O(n^2)) sobre os vértices 1..n-1
+double LimiteInferior::arvoreGeradoraDensa(double* pi) {
+	int n = this->numVertices;
+	std::vector<double> chave(n, DBL_MAX);
+	std::vector<bool> naArvore(n, false);
+	double custo = 0;
+	this->pai[0] = -1;
+	this->pai[1] = -1;
+	naArvore[1] = true;
+	this->ordemInsercao[0] = 1;
+	for (int v = 2; v < n; v++) {
+		chave[v] = this->pesoModificado(1, v, pi);
+		this->pai[v] = 1;
+	}
+	for (int cont = 1; cont < n - 1; cont++) {
+		int u = -1;
+		for (int v = 2; v < n; v++)
+			if (!naArvore[v] && (u == -1 || chave[v] < chave[u]))
+				u = v;
+		naArvore[u] = true;
+		this->ordemInsercao[cont] = u;
+		custo += chave[u];
+		for (int v = 2; v < n; v++) {
+			if (!naArvore[v]) {
+				double c = this->pesoModificado(u, v, pi);
+				if (c < chave[v]) {
+					chave[v] = c;
+					this->pai[v] = u;
+				}
+			}
+		}
+	}
+	return custo;
+}
+
+// árvore geradora mínima restrita ao grafo de candidatos (Prim com heap);
+// devolve false se o grafo de candidatos não alcança todos os vértices (não
+// ocorre, pois ele contém uma árvore geradora)
+bool LimiteInferior::arvoreGeradoraCandidatos(double* pi, double* custo) {
+	int n = this->numVertices;
+	std::vector<double> chave(n, DBL_MAX);
+	std::vector<bool> naArvore(n, false);
+	std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int> >,
+			std::greater<std::pair<double, int> > > heap;
+	*custo = 0;
+	this->pai[0] = -1;
+	this->pai[1] = -1;
+	chave[1] = 0;
+	heap.push(std::make_pair(0.0, 1));
+	int cont = 0;
+	while (!heap.empty()) {
+		int u = heap.top().second;
+		heap.pop();
+		if (naArvore[u])
+			continue;
+		naArvore[u] = true;
+		this->ordemInsercao[cont++] = u;
+		*custo += chave[u];
+		for (unsigned int c = 0; c < this->candidatos[u].size(); c++) {
+			int v = this->candidatos[u][c];
+			if (v == 0 || naArvore[v])
+				continue;
+			double p = this->pesoModificado(u, v, pi);
+			if (p < chave[v]) {
+				chave[v] = p;
+				this->pai[v] = u;
+				heap.push(std::make_pair(p, v));
+			}
+		}
+	}
+	return cont == n - 1;
+}
+
+// 1-árvore: árvore geradora mínima de 1..n-1 mais as duas arestas mais leves
+// do vértice 0; preenche o grau de cada vértice e devolve o custo modificado
+double LimiteInferior::calcularUmaArvore(double* pi, bool usarCandidatos, int* grau) {
+	int n = this->numVertices;
+	double custo;
+	if (!usarCandidatos || !this->arvoreGeradoraCandidatos(pi, &custo))
+		custo = this->arvoreGeradoraDensa(pi);
+
+	this->especial1 = -1;
+	this->especial2 = -1;
+	for (int v = 1; v < n; v++) {
+		double c = this->pesoModificado(0, v, pi);
+		if (this->especial1 == -1 || c < this->pesoModificado(0, this->especial1, pi)) {
+			this->especial2 = this->especial1;
+			this->especial1 = v;
+		} else if (this->especial2 == -1 || c < this->pesoModificado(0, this->especial2, pi)) {
+			this->especial2 = v;
+		}
+	}
+	custo += this->pesoModificado(0, this->especial1, pi) + this->pesoModificado(0, this->especial2, pi);
+
+	for (int v = 0; v < n; v++)
+		grau[v] = 0;
+	for (int v = 2; v < n; v++) {
+		grau[v]++;
+		grau[this->pai[v]]++;
+	}
+	grau[0] = 2;
+	grau[this->especial1]++;
+	grau[this->especial2]++;
+	return custo;
+}
+
+double LimiteInferior::custoVizinhoMaisProximo() {
+	int n = this->numVertices;
+	std::vector<bool> visitado(n, false);
+	double custo = 0;
+	int atual = 0;
+	visitado[0] = true;
+	for (int cont = 1; cont < n; cont++) {
+		int proximo = -1;
+		for (int v = 0; v < n; v++)
+			if (!visitado[v] && (proximo == -1 || this->peso(atual, v) < this->peso(atual, proximo)))
+				proximo = v;
+		visitado[proximo] = true;
+		custo += this->peso(atual, proximo);
+		atual = proximo;
+	}
+	return custo + this->peso(atual, 0);
+}
+
+// otimização por subgradiente com passo de Polyak: t = mu * (UB - w) / |g|^2,
+// mu reduzido à metade quando o limite para de melhorar
+double LimiteInferior::calcular(double limiteSuperior, int maxIteracoes) {
+	int n = this->numVertices;
+	if (n < 3) {
+		this->limite = (n == 2 ? 2 * this->peso(0, 1) : 0);
+		this->calculado = true;
+		return this->limite;
+	}
+	if (limiteSuperior <= 0)
+		limiteSuperior = this->custoVizinhoMaisProximo();
+
+	double* piAtual = new double[n]();
+	int* grau = new int[n];
+	double melhor = -DBL_MAX;
+	double mu = 2;
+	int semMelhora = 0;
+	int periodo = std::max(10, std::min(n / 2, 100));
+
+	for (int it = 0; it < maxIteracoes; it++) {
+		// de tempos em tempos a árvore densa acrescenta as arestas que os pi
+		// atuais favorecem e o grafo de candidatos ainda não tem
+		bool densa = (it > 0 && it % IteracoesEntreArvoresDensas == 0);
+		double custo = this->calcularUmaArvore(piAtual, !densa, grau);
+		if (densa)
+			this->acrescentarArestasArvore();
+		double somaPi = 0;
+		for (int v = 0; v < n; v++)
+			somaPi += piAtual[v];
+		double w = custo - 2 * somaPi;
+
+		if (w > melhor) {
+			melhor = w;
+			std::copy(piAtual, piAtual + n, this->pi);
+			semMelhora = 0;
+		} else if (++semMelhora >= periodo) {
+			mu /= 2;
+			semMelhora = 0;
+		}
+
+		double norma = 0;
+		for (int v = 0; v < n; v++)
+			norma += (grau[v] - 2) * (grau[v] - 2);
+		if (norma == 0 || mu < 1e-6 || w >= limiteSuperior)
+			break; // 1-árvore é um circuito, ou o passo ficou insignificante
+
+		double t = mu * (limiteSuperior - w) / norma;
+		for (int v = 0; v < n; v++)
+			piAtual[v] += t * (grau[v] - 2);
+	}
+
+	// confirmar o limite com a 1-árvore sobre o grafo completo
+	double custo = this->calcularUmaArvore(this->pi, false, grau);
+	double somaPi = 0;
+	for (int v = 0; v < n; v++)
+		somaPi += this->pi[v];
+	this->limite = custo - 2 * somaPi;
+	this->calculado = true;
+
+	delete[] piAtual;
+	delete[] grau;
+	return this->limite;
+}
+
+double LimiteInferior::obterLimite() {
+	return this->limite;
+}
+
+// preenche ordem com todos os vértices em ordem crescente de alfa em relação a
+// vertice (o próprio vértice vai para o fim); requer calcular() antes
+void LimiteInferior::calcularOrdemAlfa(int vertice, int* ordem) {
+	int n = this->numVertices;
+	std::vector<double> alfa(n, 0);
+	std::vector<double> pesoVertice(n, 0);
+	std::vector<int> indices;
+	for (int j = 0; j < n; j++) {
+		if (j == vertice)
+			continue;
+		indices.push_back(j);
+		pesoVertice[j] = this->peso(vertice, j);
+	}
+
+	if (n >= 3) {
+		double maiorEspecial = std::max(this->pesoModificado(0, this->especial1, this->pi),
+				this->pesoModificado(0, this->especial2, this->pi));
+		if (vertice == 0) {
+			for (int j = 1; j < n; j++)
+				if (j != this->especial1 && j != this->especial2)
+					alfa[j] = this->pesoModificado(0, j, this->pi) - maiorEspecial;
+		} else {
+			// beta[j]: maior aresta no caminho da árvore entre vertice e j
+			std::vector<double> beta(n, -DBL_MAX);
+			std::vector<bool> marcado(n, false);
+			marcado[vertice] = true;
+			for (int k = vertice; this->pai[k] != -1; k = this->pai[k]) {
+				beta[this->pai[k]] = std::max(beta[k], this->pesoModificado(k, this->pai[k], this->pi));
+				marcado[this->pai[k]] = true;
+			}
+			for (int c = 0; c < n - 1; c++) {
+				int j = this->ordemInsercao[c];
+				if (!marcado[j])
+					beta[j] = std::max(beta[this->pai[j]], this->pesoModificado(j, this->pai[j], this->pi));
+			}
+			for (int j = 1; j < n; j++)
+				if (j != vertice)
+					alfa[j] = this->pesoModificado(vertice, j, this->pi) - beta[j];
+			if (vertice != this->especial1 && vertice != this->especial2)
+				alfa[0] = this->pesoModificado(vertice, 0, this->pi) - maiorEspecial;
+		}
+	}
+
+	ComparaAlfa compara;
+	compara.alfa = &alfa;
+	compara.peso = &pesoVertice;
+	std::sort(indices.begin(), indices.end(), compara);
+	for (unsigned int c = 0; c < indices.size(); c++)
+		ordem[c] = indices[c];
+	ordem[n - 1] = vertice;
+}
@@ -0,0 +1,51 @@
+/*
+ * LimiteInferior.h
+ *
+ *  Limite inferior de Held-Karp: 1-árvore com multiplicadores pi ajustados por
+ *  otimização por subgradiente. As iterações usam um grafo de candidatos
+ *  (k vizinhos mais próximos e a árvore geradora mínima com pi = 0, para que
+ *  seja conexo), ao qual a cada 100 iterações são acrescentadas as arestas da
+ *  árvore sobre o grafo completo; o limite final é sempre confirmado com a
+ *  1-árvore sobre o grafo completo, então é válido mesmo que o grafo de
+ *  candidatos não contenha a árvore geradora mínima.
+ *
+ *  Os valores alfa (alpha-nearness) da 1-árvore final dão uma ordem de
+ *  candidatos melhor que a distância pura para a busca local rápida.
+ */
+
+#ifndef LIMITEINFERIOR_H_
+#define LIMITEINFERIOR_H_
+
+#include <vector>
+
+class LimiteInferior {
+private:
+	int numVertices;
+	double** pesos; // pesos[i][j] com i < j, mesma convenção do TSPsolver
+	std::vector<std::vector<int> > candidatos;
+	double* pi;
+	double limite;
+	bool calculado;
+	// 1-árvore com os melhores pi: vértice 0 é o especial, os demais formam
+	// uma árvore geradora mínima enraizada em 1
+	int* pai;
+	int* ordemInsercao;
+	int especial1;
+	int especial2;
+
+	double peso(int i, int j);
+	double pesoModificado(int i, int j, double* pi);
+	double calcularUmaArvore(double* pi, bool usarCandidatos, int* grau);
+	double arvoreGeradoraDensa(double* pi);
+	bool arvoreGeradoraCandidatos(double* pi, double* custo);
+	void acrescentarArestasArvore();
+	double custoVizinhoMaisProximo();
+public:
+	LimiteInferior(int nv, double** pesos, int numCandidatos);
+	double calcular(double limiteSuperior, int maxIteracoes);
+	double obterLimite();
+	void calcularOrdemAlfa(int vertice, int* ordem);
+	virtual ~LimiteInferior();
+};
+
+#endif /* LIMITEINFERIOR_H_ */
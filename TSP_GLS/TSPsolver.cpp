@@ -11,11 +11,12 @@
 #include <cstdio>
 #include <algorithm>
 #include <cfloat>
-#include <time.h>
 #include <string>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
-TSPsolver::TSPsolver(int nv, double** c, double lambda, int iteracoes, int opcao) {
+TSPsolver::TSPsolver(int nv, double** c, double lambda, int iteracoes, int opcao, uint64_t semente) {
 	this->numVertices = nv;
 	this->lambda = lambda;
 	this->iteracoes = iteracoes;
@@ -28,9 +29,26 @@ TSPsolver::TSPsolver(int nv, double** c, double lambda, int iteracoes, int opcao
 	}
 	this->penalidade = new int*[this->numVertices - 1];
 	for (int i = 0; i < this->numVertices - 1; i++) {
-		this->penalidade[i] = new int[this->numVertices];
+		this->penalidade[i] = new int[this->numVertices]();
 	}
-	this->featureSubNeighborhoodActivation = new bool[this->numVertices];
+	this->featureSubNeighborhoodActivation = new bool[this->numVertices]();
+	this->numSubNeighborhoodsActive = 0;
+	this->sucessor = NULL;
+	this->verboso = true;
+	this->gerador.semear(semente);
+	this->limiteInferior = NULL;
+	this->gapParada = 0;
+	this->metaheuristica = TSPsolverOpcao::OpcaoMetaheuristicaGLS;
+	this->solucaoInicial = NULL;
+	this->partidaAquecida = false;
+	this->manterPenalidades = false;
+	this->intervaloCheckpoint = 0;
+	this->iteracaoRetomada = -1;
+	this->gravador = NULL;
+	this->sementeOrdemAleatoria = semente;
+	this->varreduras = NULL;
+	this->trocasVarredura = NULL;
+	this->chaveVarredura = 0;
 }
 
 TSPsolver::~TSPsolver() {
@@ -38,6 +56,242 @@ TSPsolver::~TSPsolver() {
 		delete[] this->pesos[i];
 		delete[] this->penalidade[i];
 	}
+	delete[] this->pesos;
+	delete[] this->penalidade;
+	if (this->sucessor != NULL) {
+		for (int i = 0; i < this->numVertices; i++)
+			delete[] this->sucessor[i];
+		delete[] this->sucessor;
+	}
+	delete[] this->featureSubNeighborhoodActivation;
+	delete this->limiteInferior;
+	delete[] this->solucaoInicial;
+	delete this->gravador;
+	delete[] this->varreduras;
+	delete[] this->trocasVarredura;
+}
+
+double TSPsolver::calcularLimiteInferior(double limiteSuperior) {
+	if (this->limiteInferior == NULL) {
+		this->limiteInferior = new LimiteInferior(this->numVertices, this->pesos,
+				TSPsolverOpcao::NumCandidatosLimiteInferior);
+		this->limiteInferior->calcular(limiteSuperior, TSPsolverOpcao::MaxIteracoesLimiteInferior);
+		if (this->verboso)
+			std::printf("Limite inferior (Held-Karp): %.1f\n", this->limiteInferior->obterLimite());
+	}
+	return this->limiteInferior->obterLimite();
+}
+
+double TSPsolver::obterLimiteInferior() {
+	return (this->limiteInferior == NULL ? 0 : this->limiteInferior->obterLimite());
+}
+
+// interromper a busca quando a melhor solução estiver a até gapPercentual% do limite inferior
+void TSPsolver::definirGapParada(double gapPercentual) {
+	this->gapParada = gapPercentual;
+}
+
+bool TSPsolver::atingiuGapParada(int* melhorSolucao) {
+	if (this->gapParada <= 0)
+		return false;
+	double custo = this->funcaoCustoSolucao(melhorSolucao);
+	// limite superior da rota do vizinho mais próximo, e não a melhor solução
+	// atual: o limite não depende do estado da busca (nem de onde foi retomada)
+	double limite = this->calcularLimiteInferior(0);
+	if (limite <= 0)
+		return false;
+	double gap = 100 * (custo - limite) / limite;
+	if (gap <= this->gapParada) {
+		if (this->verboso)
+			std::printf("Gap de %.2f%% em relação ao limite inferior: fim da busca.\n", gap);
+		return true;
+	}
+	return false;
+}
+
+void TSPsolver::definirMetaheuristica(int metaheuristica) {
+	this->metaheuristica = metaheuristica;
+}
+
+void TSPsolver::definirVerbosidade(bool verboso) {
+	this->verboso = verboso;
+}
+
+namespace {
+
+// formato do checkpoint: binário na ordem de bytes da máquina, começando por
+// esta assinatura
+const char AssinaturaCheckpoint[8] = { 'T', 'S', 'P', 'G', 'L', 'S', 'C', '2' };
+
+template<typename T>
+void anexar(std::vector<char>* dados, const T* valores, int num) {
+	const char* bytes = reinterpret_cast<const char*>(valores);
+	dados->insert(dados->end(), bytes, bytes + num * sizeof(T));
+}
+
+template<typename T>
+bool ler(FILE* arq, T* valores, int num) {
+	return std::fread(valores, sizeof(T), num, arq) == (size_t) num;
+}
+
+// a rota lida visita cada cidade 0..n-1 exatamente uma vez
+bool ehPermutacao(const std::vector<int>& rota, int n) {
+	std::vector<bool> visitada(n, false);
+	for (int i = 0; i < n; i++) {
+		if (rota[i] < 0 || rota[i] >= n || visitada[rota[i]])
+			return false;
+		visitada[rota[i]] = true;
+	}
+	return true;
+}
+
+}
+
+// grava um checkpoint a cada intervalo iterações, no início da iteração;
+// a iteração em que a busca foi retomada já está no arquivo
+void TSPsolver::definirCheckpoint(const std::string& arquivo, int intervalo) {
+	this->arquivoCheckpoint = arquivo;
+	this->intervaloCheckpoint = intervalo;
+}
+
+// o laço de busca começa do estado gravado no arquivo em vez do início
+void TSPsolver::definirRetomada(const std::string& arquivo) {
+	this->arquivoRetomada = arquivo;
+}
+
+bool TSPsolver::checkpointDevido(int k) {
+	return this->intervaloCheckpoint > 0 && !this->arquivoCheckpoint.empty() && k > 0
+			&& k % this->intervaloCheckpoint == 0 && k != this->iteracaoRetomada;
+}
+
+// monta o checkpoint nesta thread e o grava em segundo plano
+void TSPsolver::salvarCheckpoint(EstadoBusca* estado) {
+	int n = this->numVertices;
+	std::vector<char> dados;
+	anexar(&dados, AssinaturaCheckpoint, 8);
+	int cabecalho[4] = { n, this->opcao, this->metaheuristica, estado->k };
+	anexar(&dados, cabecalho, 4);
+	anexar(&dados, &this->lambda, 1);
+	uint64_t estadoGerador[4];
+	this->gerador.obterEstado(estadoGerador);
+	anexar(&dados, estadoGerador, 4);
+	anexar(&dados, estado->solucaoAtual, n);
+	anexar(&dados, estado->melhorSolucao, n);
+
+	// a busca local convencional não usa as sub-vizinhanças
+	if (this->opcao != TSPsolverOpcao::OpcaoBuscaLocalConvencional) {
+		std::vector<unsigned char> bits((n + 7) / 8, 0);
+		for (int i = 0; i < n; i++)
+			if (this->featureSubNeighborhoodActivation[i])
+				bits[i / 8] |= (unsigned char) (1 << (i % 8));
+		anexar(&dados, bits.data(), (int) bits.size());
+	}
+	// a ordem aleatória é refeita a partir da semente e das varreduras de cada linha
+	if (this->varreduras != NULL) {
+		anexar(&dados, &this->sementeOrdemAleatoria, 1);
+		anexar(&dados, this->varreduras, n);
+	}
+
+	anexar(&dados, &estado->melhorCusto, 1);
+	int contadores[3] = { estado->iteracoesSemMelhora, estado->aceitas, estado->melhorias };
+	anexar(&dados, contadores, 3);
+
+	int numPenalidades = this->contarPenalidadesNaoNulas();
+	std::vector<int> origem(numPenalidades), destino(numPenalidades), valor(numPenalidades);
+	this->obterPenalidades(origem.data(), destino.data(), valor.data());
+	anexar(&dados, &numPenalidades, 1);
+	for (int a = 0; a < numPenalidades; a++) {
+		int aresta[3] = { origem[a], destino[a], valor[a] };
+		anexar(&dados, aresta, 3);
+	}
+
+	if (this->gravador == NULL)
+		this->gravador = new GravadorAssincrono();
+	this->gravador->gravar(this->arquivoCheckpoint, &dados);
+	if (this->verboso)
+		std::printf("Checkpoint da iteração %d em %s\n", estado->k, this->arquivoCheckpoint.c_str());
+}
+
+// restaura o estado gravado por salvarCheckpoint; se o arquivo não existe ou
+// não corresponde a esta instância e configuração, a busca começa do início
+bool TSPsolver::carregarCheckpoint(EstadoBusca* estado) {
+	int n = this->numVertices;
+	FILE* arq = std::fopen(this->arquivoRetomada.c_str(), "rb");
+	if (arq == NULL) {
+		std::printf("Erro ao abrir checkpoint %s: busca iniciada do começo.\n", this->arquivoRetomada.c_str());
+		return false;
+	}
+
+	char assinatura[8];
+	int cabecalho[4];
+	bool ok = ler(arq, assinatura, 8) && std::memcmp(assinatura, AssinaturaCheckpoint, 8) == 0
+			&& ler(arq, cabecalho, 4) && cabecalho[0] == n && cabecalho[1] == this->opcao
+			&& cabecalho[2] == this->metaheuristica;
+
+	double lambda = 0;
+	uint64_t estadoGerador[4];
+	std::vector<int> solucaoAtual(n), melhorSolucao(n);
+	bool usarBits = (this->opcao != TSPsolverOpcao::OpcaoBuscaLocalConvencional);
+	std::vector<unsigned char> bits(usarBits ? (n + 7) / 8 : 0);
+	uint64_t sementeOrdemAleatoria = 0;
+	std::vector<int> varreduras(this->varreduras != NULL ? n : 0);
+	double melhorCusto = 0;
+	int contadores[3] = { 0, 0, 0 };
+	int numPenalidades = 0;
+	ok = ok && ler(arq, &lambda, 1) && ler(arq, estadoGerador, 4) && ler(arq, solucaoAtual.data(), n)
+			&& ler(arq, melhorSolucao.data(), n) && ler(arq, bits.data(), (int) bits.size())
+			&& (this->varreduras == NULL || (ler(arq, &sementeOrdemAleatoria, 1)
+					&& ler(arq, varreduras.data(), n)))
+			&& ler(arq, &melhorCusto, 1) && ler(arq, contadores, 3) && ler(arq, &numPenalidades, 1)
+			&& numPenalidades >= 0 && numPenalidades <= (int64_t) n * (n - 1) / 2
+			&& ehPermutacao(solucaoAtual, n) && ehPermutacao(melhorSolucao, n);
+	std::vector<int> origem, destino, valor;
+	for (int a = 0; ok && a < numPenalidades; a++) {
+		int aresta[3];
+		ok = ler(arq, aresta, 3);
+		origem.push_back(aresta[0]);
+		destino.push_back(aresta[1]);
+		valor.push_back(aresta[2]);
+	}
+	std::fclose(arq);
+	if (!ok) {
+		std::printf("Checkpoint %s inválido para esta instância: busca iniciada do começo.\n",
+				this->arquivoRetomada.c_str());
+		return false;
+	}
+
+	this->lambda = lambda;
+	this->gerador.definirEstado(estadoGerador);
+	std::copy(solucaoAtual.begin(), solucaoAtual.end(), estado->solucaoAtual);
+	std::copy(melhorSolucao.begin(), melhorSolucao.end(), estado->melhorSolucao);
+	if (usarBits) {
+		this->numSubNeighborhoodsActive = 0;
+		for (int i = 0; i < n; i++) {
+			this->featureSubNeighborhoodActivation[i] = (bits[i / 8] >> (i % 8)) & 1;
+			if (this->featureSubNeighborhoodActivation[i])
+				this->numSubNeighborhoodsActive++;
+		}
+	}
+	if (this->varreduras != NULL) {
+		this->sementeOrdemAleatoria = sementeOrdemAleatoria;
+		std::copy(varreduras.begin(), varreduras.end(), this->varreduras);
+	}
+	estado->melhorCusto = melhorCusto;
+	estado->iteracoesSemMelhora = contadores[0];
+	estado->aceitas = contadores[1];
+	estado->melhorias = contadores[2];
+	this->definirPenalidadesAnteriores(numPenalidades, origem.data(), destino.data(), valor.data());
+	estado->k = cabecalho[3];
+	this->iteracaoRetomada = estado->k;
+
+	if (this->verboso)
+		std::printf("Busca retomada na iteração %d de %s\n", estado->k, this->arquivoRetomada.c_str());
+	return true;
+}
+
+void TSPsolver::aguardarCheckpoint() {
+	if (this->gravador != NULL)
+		this->gravador->aguardar();
 }
 
 int* TSPsolver::resolver() {
@@ -49,6 +303,8 @@ int* TSPsolver::resolver() {
 		double custo = this->funcaoCustoSolucao(solucaoAleatoria);
 		lambda = 0.3 * custo / this->numVertices;
 	}
+	if (this->metaheuristica == TSPsolverOpcao::OpcaoMetaheuristicaILS)
+		return iteratedLocalSearch();
 	if (this->opcao == TSPsolverOpcao::OpcaoBuscaLocalConvencional)
 		return guidedLocalSearch();
 	else
@@ -98,6 +354,38 @@ double TSPsolver::expressaoUtilidade(int* solucao, int indCaracteristica) {
 	return util;
 }
 
+void TSPsolver::penalizarArestasUtilidadeMaxima(int* solucao, double* util, bool ativarSubVizinhancas) {
+	double maxUtil = 0;
+	for (int i = 0; i < this->numVertices; i++) {
+		util[i] = this->expressaoUtilidade(solucao, i);
+		if (util[i] > maxUtil)
+			maxUtil = util[i];
+	}
+	for (int i = 0; i < this->numVertices; i++) {
+		if (util[i] == maxUtil) {
+			int atual = solucao[i];
+			int sucessor = solucao[(i + 1) % this->numVertices];
+			ajustaIndices(&atual, &sucessor);
+			this->penalidade[atual][sucessor]++;
+
+			if (ativarSubVizinhancas) {
+				// ativar sub-vizinhanças relacionadas aos vértices da aresta penalizada
+				if (!this->featureSubNeighborhoodActivation[atual]) {
+					this->featureSubNeighborhoodActivation[atual] = true;
+					numSubNeighborhoodsActive++;
+				}
+				if (!this->featureSubNeighborhoodActivation[sucessor]) {
+					this->featureSubNeighborhoodActivation[sucessor] = true;
+					numSubNeighborhoodsActive++;
+				}
+			}
+
+			if (this->verboso)
+				std::printf("--> aresta (%d, %d) penalizada: %d\n", atual + 1, sucessor + 1, this->penalidade[atual][sucessor]);
+		}
+	}
+}
+
 void copiarVetor(int* origem, int* destino, int numElementos) {
 	for (int i = 0; i < numElementos; i++) {
 		destino[i] = origem[i];
@@ -106,50 +394,96 @@ void copiarVetor(int* origem, int* destino, int numElementos) {
 
 int* TSPsolver::guidedLocalSearch() {
 	int k = 0;
-	int* solucaoInicial = this->gerarSolucaoArbitraria();
+	int* solucaoInicial = this->obterSolucaoInicial();
 	int* melhorSolucao = new int[this->numVertices];
 	copiarVetor(solucaoInicial, melhorSolucao, this->numVertices);
-	for (int i = 0; i < this->numVertices - 1; i++)
-		for (int j = 0; j < this->numVertices; j++)
-			this->penalidade[i][j] = 0;
+	this->inicializarPenalidades();
 
 	int* solucaoAtual = solucaoInicial;
 	double* util = new double[this->numVertices];
 
-	int* solucaoSucessora;
+	int* solucaoSucessora = NULL;
+
+	// híbrido: chute double-bridge quando a melhor solução estagna
+	bool usarChute = (this->metaheuristica == TSPsolverOpcao::OpcaoMetaheuristicaGLSComChute);
+	int iteracoesSemMelhora = 0;
+
+	std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+	double melhorCusto = this->funcaoCustoSolucao(melhorSolucao);
+	int melhorias = 0;
+
+	if (!this->arquivoRetomada.empty()) {
+		EstadoBusca estado = { k, solucaoAtual, melhorSolucao, melhorCusto, iteracoesSemMelhora, 0, melhorias };
+		if (this->carregarCheckpoint(&estado)) {
+			k = estado.k;
+			melhorCusto = estado.melhorCusto;
+			iteracoesSemMelhora = estado.iteracoesSemMelhora;
+			melhorias = estado.melhorias;
+		}
+	}
 
 	while (k < this->iteracoes) {
-		std::printf("Iteração: %d\n", k);
+		if (this->checkpointDevido(k)) {
+			EstadoBusca estado = { k, solucaoAtual, melhorSolucao, melhorCusto, iteracoesSemMelhora, 0,
+					melhorias };
+			this->salvarCheckpoint(&estado);
+		}
 
-		solucaoSucessora = this->localSearch(solucaoAtual, melhorSolucao, true);
+		if (this->verboso)
+			std::printf("Iteração: %d\n", k);
 
-		double maxUtil = 0;
-		for (int i = 0; i < this->numVertices; i++) {
-			util[i] = this->expressaoUtilidade(solucaoSucessora, i);
-			if (util[i] > maxUtil)
-				maxUtil = util[i];
+		solucaoSucessora = this->localSearch(solucaoAtual, melhorSolucao, true);
+		// a próxima busca parte do ótimo local encontrado
+		delete[] solucaoAtual;
+		solucaoAtual = solucaoSucessora;
+
+		double custo = this->funcaoCustoSolucao(melhorSolucao);
+		bool melhorou = (custo < melhorCusto);
+		if (melhorou) {
+			melhorCusto = custo;
+			melhorias++;
 		}
-		for (int i = 0; i < this->numVertices; i++) {
-			if (util[i] == maxUtil) {
-				int atual = solucaoSucessora[i];
-				int sucessor = solucaoSucessora[(i + 1) % this->numVertices];
-				ajustaIndices(&atual, &sucessor);
-				this->penalidade[atual][sucessor]++;
 
-				std::printf("--> aresta (%d, %d) penalizada: %d\n", atual + 1, sucessor + 1, this->penalidade[atual][sucessor]);
+		if (this->atingiuGapParada(melhorSolucao))
+			break;
+
+		this->penalizarArestasUtilidadeMaxima(solucaoAtual, util, false);
+
+		if (usarChute) {
+			if (melhorou) {
+				iteracoesSemMelhora = 0;
+			} else if (++iteracoesSemMelhora >= TSPsolverOpcao::IteracoesSemMelhoraChute) {
+				if (this->verboso)
+					std::printf("--> chute double-bridge\n");
+				this->aplicarChuteDoubleBridge(solucaoAtual);
+				iteracoesSemMelhora = 0;
 			}
 		}
 
 		k++;
 	}
 
+	this->relatarMelhorias(usarChute ? TSPsolverOpcao::StrOpcaoMetaheuristicaGLSComChute :
+			TSPsolverOpcao::StrOpcaoMetaheuristicaGLS, melhorias, k,
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count());
+	this->aguardarCheckpoint();
 	delete[] solucaoAtual;
-	delete[] solucaoSucessora;
+	delete[] util;
 
 	return melhorSolucao;
 }
 
+void TSPsolver::alocarMatrizSucessores() {
+	if (this->sucessor != NULL)
+		return;
+	this->sucessor = new int*[this->numVertices];
+	for (int i = 0; i < this->numVertices; i++) {
+		this->sucessor[i] = new int[this->numVertices];
+	}
+}
+
 void TSPsolver::calcularMatrizSucessoresOrdenada(bool ordemCrescente) {
+	this->alocarMatrizSucessores();
 	for (int i = 0; i < this->numVertices; i++) {
 		// iniciar adjacentes com sequência
 		for (int j = 0; j < this->numVertices; j++)
@@ -183,108 +517,321 @@ void TSPsolver::calcularMatrizSucessoresOrdenada(bool ordemCrescente) {
 	}
 }
 
-void TSPsolver::calcularMatrizSucessoresAleatoria() {
-	srand(time(NULL));
-	for (int i = 0; i < this->numVertices; i++) {
-		// iniciar adjacentes com sequência
-		for (int j = 0; j < this->numVertices; j++)
-			this->sucessor[i][j] = j;
+void TSPsolver::calcularMatrizSucessoresAlfa() {
+	this->alocarMatrizSucessores();
+	if (this->limiteInferior == NULL)
+		this->calcularLimiteInferior(0);
+	for (int i = 0; i < this->numVertices; i++)
+		this->limiteInferior->calcularOrdemAlfa(i, this->sucessor[i]);
+}
 
-		// efetuar numVertices trocas aleatórias
-		for (int j = 0; j < this->numVertices; j++) {
-			int ind1 = rand() % this->numVertices;
-			int ind2 = rand() % this->numVertices;
-			if (ind2 == ind1)
-				ind2 = (ind1 * 3) % this->numVertices;
-			// trocar valores das posições ind1 e ind2
-			int temp = this->sucessor[i][ind1];
-			this->sucessor[i][ind1] = this->sucessor[i][ind2];
-			this->sucessor[i][ind2] = temp;
+// monta a matriz de sucessores antes da busca
+void TSPsolver::prepararMatrizSucessores() {
+	// na ordem aleatória não há matriz: cada varredura de uma linha sorteia os
+	// candidatos à medida que são visitados (sortearCandidatoAleatorio)
+	if (this->opcao == TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasAleatorias) {
+		if (this->varreduras == NULL) {
+			this->varreduras = new int[this->numVertices]();
+			this->trocasVarredura = new int[this->numVertices];
+			std::fill(this->trocasVarredura, this->trocasVarredura + this->numVertices, -1);
 		}
+		return;
 	}
+	this->alocarMatrizSucessores();
+	// a ordem por alfa não depende das penalidades: calculada uma única vez
+	if (this->opcao == TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasAlfa)
+		this->calcularMatrizSucessoresAlfa();
 }
 
-int* TSPsolver::guidedLocalSearchWithFastLocalSearch() {
-	// criar matriz de sucessores ordenados por distância a partir de um vértice
-	this->sucessor = new int*[this->numVertices];
-	for (int i = 0; i < this->numVertices; i++) {
-		this->sucessor[i] = new int[this->numVertices];
+// j-ésimo candidato da varredura atual da linha: Fisher-Yates preguiçoso sobre
+// 0..n-1, com cada sorteio calculado de (semente, linha, número da varredura, j).
+// Só as posições trocadas são guardadas, e a ordem pode ser refeita a partir
+// dos contadores de varredura (checkpoint) sem gravar uma matriz N x N
+int TSPsolver::sortearCandidatoAleatorio(int linha, int j) {
+	if (j == 0)
+		this->chaveVarredura = GeradorAleatorio::misturar(
+				GeradorAleatorio::misturar(this->sementeOrdemAleatoria + linha) + this->varreduras[linha]++);
+	uint64_t sorteio = GeradorAleatorio::misturar(this->chaveVarredura + j);
+	int ind = j + (int) (((sorteio >> 32) * (uint64_t) (this->numVertices - j)) >> 32);
+	int candidato = (this->trocasVarredura[ind] >= 0 ? this->trocasVarredura[ind] : ind);
+	if (ind != j) {
+		if (this->trocasVarredura[ind] < 0)
+			this->posicoesTrocadas.push_back(ind);
+		this->trocasVarredura[ind] = (this->trocasVarredura[j] >= 0 ? this->trocasVarredura[j] : j);
 	}
+	return candidato;
+}
+
+void TSPsolver::encerrarVarreduraAleatoria() {
+	for (unsigned int p = 0; p < this->posicoesTrocadas.size(); p++)
+		this->trocasVarredura[this->posicoesTrocadas[p]] = -1;
+	this->posicoesTrocadas.clear();
+}
 
-	for (int i = 0; i < this->numVertices; i++) { // for every city
-		featureSubNeighborhoodActivation[i] = true; // activate feature neighborhood
+// as ordens por peso consideram as penalidades e são refeitas a cada iteração
+void TSPsolver::atualizarMatrizSucessores() {
+	switch (this->opcao) {
+	case TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasMenoresPrimeiro:
+		this->calcularMatrizSucessoresOrdenada(true);
+		break;
+	case TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasMaioresPrimeiro:
+		this->calcularMatrizSucessoresOrdenada(false);
+		break;
 	}
-	this->numSubNeighborhoodsActive = this->numVertices;
+}
 
-	int k = 0;
-	int* solucaoInicial = this->gerarSolucaoArbitraria();
-	int* melhorSolucao = new int[this->numVertices];
-	copiarVetor(solucaoInicial, melhorSolucao, this->numVertices);
+void TSPsolver::ativarSubVizinhanca(int cidade) {
+	if (!this->featureSubNeighborhoodActivation[cidade]) {
+		this->featureSubNeighborhoodActivation[cidade] = true;
+		numSubNeighborhoodsActive++;
+	}
+}
+
+// ativa todas as sub-vizinhanças, ou, na partida aquecida, só as das cidades
+// afetadas pela mudança da instância
+void TSPsolver::inicializarSubVizinhancas() {
+	bool ativarTodas = !this->partidaAquecida;
+	for (int i = 0; i < this->numVertices; i++)
+		featureSubNeighborhoodActivation[i] = ativarTodas;
+	this->numSubNeighborhoodsActive = (ativarTodas ? this->numVertices : 0);
+	if (!ativarTodas)
+		for (unsigned int c = 0; c < this->cidadesAfetadas.size(); c++)
+			this->ativarSubVizinhanca(this->cidadesAfetadas[c]);
+}
+
+// zera as penalidades, a menos que penalidades anteriores tenham sido definidas
+void TSPsolver::inicializarPenalidades() {
+	if (this->manterPenalidades)
+		return;
 	for (int i = 0; i < this->numVertices - 1; i++)
 		for (int j = 0; j < this->numVertices; j++)
 			this->penalidade[i][j] = 0;
+}
+
+// resumo para comparar os modos: quantas iterações melhoraram a melhor solução
+// e o tempo de busca gasto por melhoria
+void TSPsolver::relatarMelhorias(const std::string& modo, int melhorias, int iteracoes, double segundos) {
+	if (!this->verboso)
+		return;
+	std::printf("%s: %d melhorias em %d iterações, %.3f s", modo.c_str(), melhorias, iteracoes, segundos);
+	if (melhorias > 0)
+		std::printf(", %.4f s por melhoria", segundos / melhorias);
+	std::printf("\n");
+}
+
+// double-bridge local: troca dois segmentos consecutivos (A B C D -> A C B D)
+// dentro de uma janela aleatória de até TamanhoJanelaChute posições; só as
+// cidades nas extremidades dos cortes têm a sub-vizinhança reativada
+void TSPsolver::aplicarChuteDoubleBridge(int* rota) {
+	int n = this->numVertices;
+	if (n < 8)
+		return;
+	int janela = std::min(TSPsolverOpcao::TamanhoJanelaChute, n - 1);
+	int x = this->gerador.inteiro(n - janela);
+	int a = 1 + this->gerador.inteiro(janela);
+	int b = 1 + this->gerador.inteiro(janela - 1);
+	if (b >= a)
+		b++;
+	int y = x + std::min(a, b);
+	int z = x + std::max(a, b);
+
+	this->ativarSubVizinhanca(rota[x]);
+	this->ativarSubVizinhanca(rota[x + 1]);
+	this->ativarSubVizinhanca(rota[y]);
+	this->ativarSubVizinhanca(rota[y + 1]);
+	this->ativarSubVizinhanca(rota[z]);
+	this->ativarSubVizinhanca(rota[(z + 1) % n]);
+
+	// B = rota[x+1..y], C = rota[y+1..z]
+	int tamanho = z - x;
+	int* temp = new int[tamanho];
+	copiarVetor(rota + x + 1, temp, tamanho);
+	int tamanhoB = y - x;
+	int tamanhoC = z - y;
+	copiarVetor(temp + tamanhoB, rota + x + 1, tamanhoC);
+	copiarVetor(temp, rota + x + 1 + tamanhoC, tamanhoB);
+	delete[] temp;
+}
+
+int* TSPsolver::guidedLocalSearchWithFastLocalSearch() {
+	// criar matriz de sucessores ordenados por distância a partir de um vértice
+	this->prepararMatrizSucessores();
+
+	this->inicializarSubVizinhancas();
+
+	int k = 0;
+	int* solucaoInicial = this->obterSolucaoInicial();
+	int* melhorSolucao = new int[this->numVertices];
+	copiarVetor(solucaoInicial, melhorSolucao, this->numVertices);
+	this->inicializarPenalidades();
 
 	int* solucaoAtual = solucaoInicial;
 	double* util = new double[this->numVertices];
 
-	int* solucaoSucessora;
+	int* solucaoSucessora = NULL;
+
+	// híbrido: chute double-bridge quando a melhor solução estagna
+	bool usarChute = (this->metaheuristica == TSPsolverOpcao::OpcaoMetaheuristicaGLSComChute);
+	double melhorCusto = this->funcaoCustoSolucao(melhorSolucao);
+	int iteracoesSemMelhora = 0;
+
+	std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+	int melhorias = 0;
+
+	if (!this->arquivoRetomada.empty()) {
+		EstadoBusca estado = { k, solucaoAtual, melhorSolucao, melhorCusto, iteracoesSemMelhora, 0, melhorias };
+		if (this->carregarCheckpoint(&estado)) {
+			k = estado.k;
+			melhorCusto = estado.melhorCusto;
+			iteracoesSemMelhora = estado.iteracoesSemMelhora;
+			melhorias = estado.melhorias;
+		}
+	}
 
 	while (k < this->iteracoes) {
-		if (k % 5000 == 0) { // zerar penalidades
+		if (this->checkpointDevido(k)) {
+			EstadoBusca estado = { k, solucaoAtual, melhorSolucao, melhorCusto, iteracoesSemMelhora, 0,
+					melhorias };
+			this->salvarCheckpoint(&estado);
+		}
+
+		if (k > 0 && k % 5000 == 0) { // zerar penalidades
 			for (int i = 0; i < this->numVertices - 1; i++)
 				for (int j = 0; j < this->numVertices; j++)
 					this->penalidade[i][j] = 0;
 		}
 		// atualizar matriz de sucessores
-		switch (this->opcao) {
-		case TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasAleatorias:
-			this->calcularMatrizSucessoresAleatoria();
-			break;
-		case TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasMenoresPrimeiro:
-			this->calcularMatrizSucessoresOrdenada(true);
-			break;
-		case TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasMaioresPrimeiro:
-			this->calcularMatrizSucessoresOrdenada(false);
-			break;
-		}
+		this->atualizarMatrizSucessores();
 
-		std::printf("Iteração: %d\n", k);
+		if (this->verboso)
+			std::printf("Iteração: %d\n", k);
 
 		solucaoSucessora = this->fastLocalSearch(solucaoAtual, melhorSolucao, TSPsolverOpcao::OpcaoPrimeiroAprimorante,
 				true);
-
-		double maxUtil = 0;
-		for (int i = 0; i < this->numVertices; i++) {
-			util[i] = this->expressaoUtilidade(solucaoSucessora, i);
-			if (util[i] > maxUtil)
-				maxUtil = util[i];
+		// a próxima busca parte do ótimo local encontrado
+		delete[] solucaoAtual;
+		solucaoAtual = solucaoSucessora;
+
+		double custo = this->funcaoCustoSolucao(melhorSolucao);
+		bool melhorou = (custo < melhorCusto);
+		if (melhorou) {
+			melhorCusto = custo;
+			melhorias++;
 		}
-		for (int i = 0; i < this->numVertices; i++) {
-			if (util[i] == maxUtil) {
-				int atual = solucaoSucessora[i];
-				int sucessor = solucaoSucessora[(i + 1) % this->numVertices];
-				ajustaIndices(&atual, &sucessor);
-				this->penalidade[atual][sucessor]++;
 
-				// ativar sub-vizinhanças relacionadas aos vértices da aresta penalizada
-				if (!this->featureSubNeighborhoodActivation[atual]) {
-					this->featureSubNeighborhoodActivation[atual] = true;
-					numSubNeighborhoodsActive++;
-				}
-				if (!this->featureSubNeighborhoodActivation[sucessor]) {
-					this->featureSubNeighborhoodActivation[sucessor] = true;
-					numSubNeighborhoodsActive++;
-				}
+		if (this->atingiuGapParada(melhorSolucao))
+			break;
 
-				std::printf("--> aresta (%d, %d) penalizada: %d\n", atual + 1, sucessor + 1, this->penalidade[atual][sucessor]);
+		this->penalizarArestasUtilidadeMaxima(solucaoAtual, util, true);
+
+		if (usarChute) {
+			if (melhorou) {
+				iteracoesSemMelhora = 0;
+			} else if (++iteracoesSemMelhora >= TSPsolverOpcao::IteracoesSemMelhoraChute) {
+				if (this->verboso)
+					std::printf("--> chute double-bridge\n");
+				this->aplicarChuteDoubleBridge(solucaoAtual);
+				iteracoesSemMelhora = 0;
 			}
 		}
 
 		k++;
 	}
 
+	this->relatarMelhorias(usarChute ? TSPsolverOpcao::StrOpcaoMetaheuristicaGLSComChute :
+			TSPsolverOpcao::StrOpcaoMetaheuristicaGLS, melhorias, k,
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count());
+	this->aguardarCheckpoint();
 	delete[] solucaoAtual;
-	delete[] solucaoSucessora;
+	delete[] util;
+
+	return melhorSolucao;
+}
+
+// busca local iterada: busca local sem penalidades (a convencional no BLC, a
+// rápida nos demais métodos), perturbada por chutes double-bridge locais; o
+// ótimo local após o chute substitui o atual se não for pior que ele
+int* TSPsolver::iteratedLocalSearch() {
+	bool buscaConvencional = (this->opcao == TSPsolverOpcao::OpcaoBuscaLocalConvencional);
+	if (!buscaConvencional) {
+		this->prepararMatrizSucessores();
+		this->atualizarMatrizSucessores();
+	}
+
+	this->inicializarPenalidades();
+	this->inicializarSubVizinhancas();
+
+	int* solucaoInicial = this->obterSolucaoInicial();
+	int* melhorSolucao = new int[this->numVertices];
+	copiarVetor(solucaoInicial, melhorSolucao, this->numVertices);
+
+	std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+	int k = 0;
+	int aceitas = 0;
+	int melhorias = 0;
+	int* solucaoAtual = NULL;
+	if (!this->arquivoRetomada.empty()) {
+		solucaoAtual = new int[this->numVertices];
+		EstadoBusca estado = { k, solucaoAtual, melhorSolucao, 0, 0, 0, 0 };
+		if (this->carregarCheckpoint(&estado)) {
+			k = estado.k;
+			aceitas = estado.aceitas;
+			melhorias = estado.melhorias;
+		} else {
+			delete[] solucaoAtual;
+			solucaoAtual = NULL;
+		}
+	}
+	if (solucaoAtual == NULL)
+		solucaoAtual = (buscaConvencional ? this->localSearch(solucaoInicial, melhorSolucao, false) :
+				this->fastLocalSearch(solucaoInicial, melhorSolucao, TSPsolverOpcao::OpcaoPrimeiroAprimorante, false));
+	delete[] solucaoInicial;
+	double custoAtual = this->funcaoCustoSolucao(solucaoAtual);
+	double melhorCusto = this->funcaoCustoSolucao(melhorSolucao);
+	int* solucaoChute = new int[this->numVertices];
+
+	while (k < this->iteracoes) {
+		if (this->checkpointDevido(k)) {
+			EstadoBusca estado = { k, solucaoAtual, melhorSolucao, melhorCusto, 0, aceitas, melhorias };
+			this->salvarCheckpoint(&estado);
+		}
+
+		if (this->atingiuGapParada(melhorSolucao))
+			break;
+
+		if (this->verboso)
+			std::printf("Iteração: %d\n", k);
+
+		copiarVetor(solucaoAtual, solucaoChute, this->numVertices);
+		this->aplicarChuteDoubleBridge(solucaoChute);
+		int* otimoLocal = (buscaConvencional ? this->localSearch(solucaoChute, melhorSolucao, false) :
+				this->fastLocalSearch(solucaoChute, melhorSolucao, TSPsolverOpcao::OpcaoPrimeiroAprimorante, false));
+		double custoMelhor = this->funcaoCustoSolucao(melhorSolucao);
+		if (custoMelhor < melhorCusto) {
+			melhorCusto = custoMelhor;
+			melhorias++;
+		}
+		double custo = this->funcaoCustoSolucao(otimoLocal);
+		if (custo <= custoAtual) {
+			delete[] solucaoAtual;
+			solucaoAtual = otimoLocal;
+			custoAtual = custo;
+			aceitas++;
+		} else {
+			delete[] otimoLocal;
+		}
+
+		k++;
+	}
+
+	if (this->verboso)
+		std::printf("Chutes aceitos: %d de %d\n", aceitas, k);
+	this->relatarMelhorias(TSPsolverOpcao::StrOpcaoMetaheuristicaILS, melhorias, k,
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count());
+
+	this->aguardarCheckpoint();
+	delete[] solucaoAtual;
+	delete[] solucaoChute;
 
 	return melhorSolucao;
 }
@@ -306,16 +853,47 @@ void efetuar2opt(int* rota, int* novaRota, int numVertices, int i, int j) {
 //	std::printf(")\n");
 }
 
+// custo e custo aumentado da rota após inverter o trecho [i, j], sem construir a nova rota
+void TSPsolver::avaliarMovimento2opt(int* rota, int i, int j, double custoRota, double custoAumentadoRota,
+		double* custo, double* custoAumentado) {
+	int antecessorI = (i > 0 ? i - 1 : this->numVertices - 1);
+	int sucessorJ = (j + 1) % this->numVertices;
+	int arestaRemovida1Origem = rota[antecessorI];
+	int arestaRemovida1Destino = rota[i];
+	int arestaRemovida2Origem = rota[j];
+	int arestaRemovida2Destino = rota[sucessorJ];
+	int arestaIncluida1Origem = arestaRemovida1Origem;
+	int arestaIncluida1Destino = arestaRemovida2Origem;
+	int arestaIncluida2Origem = arestaRemovida1Destino;
+	int arestaIncluida2Destino = arestaRemovida2Destino;
+	double custoArestaRemovida1 = this->obterPesoAresta(arestaRemovida1Origem, arestaRemovida1Destino);
+	double custoArestaRemovida2 = this->obterPesoAresta(arestaRemovida2Origem, arestaRemovida2Destino);
+	double custoArestaIncluida1 = this->obterPesoAresta(arestaIncluida1Origem, arestaIncluida1Destino);
+	double custoArestaIncluida2 = this->obterPesoAresta(arestaIncluida2Origem, arestaIncluida2Destino);
+	*custo = custoRota - custoArestaRemovida1 - custoArestaRemovida2 + custoArestaIncluida1
+			+ custoArestaIncluida2;
+	*custoAumentado = custoAumentadoRota - custoArestaRemovida1
+			- this->lambda * this->obterPenalidadeAresta(arestaRemovida1Origem, arestaRemovida1Destino)
+			- custoArestaRemovida2
+			- this->lambda * this->obterPenalidadeAresta(arestaRemovida2Origem, arestaRemovida2Destino)
+			+ custoArestaIncluida1
+			+ this->lambda * this->obterPenalidadeAresta(arestaIncluida1Origem, arestaIncluida1Destino)
+			+ custoArestaIncluida2
+			+ this->lambda * this->obterPenalidadeAresta(arestaIncluida2Origem, arestaIncluida2Destino);
+}
+
 // 2-opt
 int* TSPsolver::localSearch(int* solucaoAtual, int* melhorSolucao, bool usarFuncaoCustoAumentada) {
-	std::printf(" -> Efetuando Busca local...\n");
+	if (this->verboso)
+		std::printf(" -> Efetuando Busca local...\n");
 	int* otimoLocal = new int[this->numVertices];
 	copiarVetor(solucaoAtual, otimoLocal, this->numVertices);
 	int* melhorVizinho = new int[this->numVertices];
 	copiarVetor(solucaoAtual, melhorVizinho, this->numVertices);
 
-	double custoAumentadoOtimoLocal = this->funcaoCustoSolucaoAumentada(solucaoAtual);
 	double custoOtimoLocal = this->funcaoCustoSolucao(solucaoAtual);
+	double custoAumentadoOtimoLocal = (usarFuncaoCustoAumentada ? this->funcaoCustoSolucaoAumentada(solucaoAtual) :
+			custoOtimoLocal);
 	double melhorCusto = this->funcaoCustoSolucao(melhorSolucao);
 	double custoMelhorVizinho = custoOtimoLocal;
 	double custoAumentadoMelhorVizinho = custoAumentadoOtimoLocal;
@@ -335,30 +913,11 @@ int* TSPsolver::localSearch(int* solucaoAtual, int* melhorSolucao, bool usarFunc
 				efetuar2opt(otimoLocal, novaSolucao, this->numVertices, i, j);
 //				double custo = this->funcaoCustoSolucao(novaSolucao);
 //				double custoAumentado = this->funcaoCustoSolucaoAumentada(novaSolucao);
-				int antecessorI = (i > 0 ? i - 1 : this->numVertices - 1);
-				int sucessorJ = (j + 1) % this->numVertices;
-				int arestaRemovida1Origem = otimoLocal[antecessorI];
-				int arestaRemovida1Destino = otimoLocal[i];
-				int arestaRemovida2Origem = otimoLocal[j];
-				int arestaRemovida2Destino = otimoLocal[sucessorJ];
-				int arestaIncluida1Origem = arestaRemovida1Origem;
-				int arestaIncluida1Destino = arestaRemovida2Origem;
-				int arestaIncluida2Origem = arestaRemovida1Destino;
-				int arestaIncluida2Destino = arestaRemovida2Destino;
-				double custoArestaRemovida1 = this->obterPesoAresta(arestaRemovida1Origem, arestaRemovida1Destino);
-				double custoArestaRemovida2 = this->obterPesoAresta(arestaRemovida2Origem, arestaRemovida2Destino);
-				double custoArestaIncluida1 = this->obterPesoAresta(arestaIncluida1Origem, arestaIncluida1Destino);
-				double custoArestaIncluida2 = this->obterPesoAresta(arestaIncluida2Origem, arestaIncluida2Destino);
-				double custo = custoOtimoLocal - custoArestaRemovida1 - custoArestaRemovida2 + custoArestaIncluida1
-						+ custoArestaIncluida2;
-				double custoAumentado = custoAumentadoOtimoLocal - custoArestaRemovida1
-						- this->lambda * this->obterPenalidadeAresta(arestaRemovida1Origem, arestaRemovida1Destino)
-						- custoArestaRemovida2
-						- this->lambda * this->obterPenalidadeAresta(arestaRemovida2Origem, arestaRemovida2Destino)
-						+ custoArestaIncluida1
-						+ this->lambda * this->obterPenalidadeAresta(arestaIncluida1Origem, arestaIncluida1Destino)
-						+ custoArestaIncluida2
-						+ this->lambda * this->obterPenalidadeAresta(arestaIncluida2Origem, arestaIncluida2Destino);
+				double custo, custoAumentado;
+				this->avaliarMovimento2opt(otimoLocal, i, j, custoOtimoLocal, custoAumentadoOtimoLocal,
+						&custo, &custoAumentado);
+				if (!usarFuncaoCustoAumentada)
+					custoAumentado = custo;
 
 				if (custoAumentado < custoAumentadoMelhorVizinho) {
 					copiarVetor(novaSolucao, melhorVizinho, this->numVertices);
@@ -383,12 +942,16 @@ int* TSPsolver::localSearch(int* solucaoAtual, int* melhorSolucao, bool usarFunc
 			custoAumentadoOtimoLocal = custoAumentadoMelhorVizinho;
 		}
 	} while (houveMelhora);
-
-	std::printf("\n  - custo do ótimo local..........: %.1f\n", this->funcaoCustoSolucao(otimoLocal));
-	std::printf("  - custo aumentado do ótimo local: %.1f\n", custoAumentadoOtimoLocal);
-	std::printf("  - custo da melhor solução.......: %.1f\n", melhorCusto);
-	std::printf(" -> Fim de busca local.\n");
-	std::printf(" -> Soluções avaliadas: %d\n", cont);
+	delete[] novaSolucao;
+	delete[] melhorVizinho;
+
+	if (this->verboso) {
+		std::printf("\n  - custo do ótimo local..........: %.1f\n", this->funcaoCustoSolucao(otimoLocal));
+		std::printf("  - custo aumentado do ótimo local: %.1f\n", custoAumentadoOtimoLocal);
+		std::printf("  - custo da melhor solução.......: %.1f\n", melhorCusto);
+		std::printf(" -> Fim de busca local.\n");
+		std::printf(" -> Soluções avaliadas: %d\n", cont);
+	}
 
 	return otimoLocal;
 }
@@ -402,12 +965,15 @@ double arredondar(double num, int casasDecimais) {
 
 int* TSPsolver::fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcaoAprimorante,
 		bool usarFuncaoCustoAumentada) {
-	std::printf(" -> Efetuando Busca local...\n");
+	if (this->verboso)
+		std::printf(" -> Efetuando Busca local...\n");
 	int* otimoLocal = new int[this->numVertices];
 	copiarVetor(solucaoAtual, otimoLocal, this->numVertices);
 
-	double custoAumentadoOtimoLocal = this->funcaoCustoSolucaoAumentada(solucaoAtual);
 	double custoOtimoLocal = this->funcaoCustoSolucao(solucaoAtual);
+	// sem a função aumentada a busca minimiza o custo, mesmo com penalidades mantidas
+	double custoAumentadoOtimoLocal = (usarFuncaoCustoAumentada ? this->funcaoCustoSolucaoAumentada(solucaoAtual) :
+			custoOtimoLocal);
 	double melhorCusto = this->funcaoCustoSolucao(melhorSolucao);
 
 //	std::printf("  - melhor custo aumentado: %.1f\n    ...", custoAumentadoSolucaoAtual);
@@ -421,6 +987,20 @@ int* TSPsolver::fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcao
 
 	int cont = 0;
 
+	// na ordem por alfa as linhas da matriz são de cidades e só os primeiros
+	// candidatos são examinados; a posição de cada cidade na rota é mantida
+	// para localizar o candidato
+	bool usarCandidatosAlfa = (this->opcao == TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasAlfa);
+	bool usarOrdemAleatoria = (this->opcao == TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasAleatorias);
+	int numCandidatos = this->numVertices;
+	int* posicao = NULL;
+	if (usarCandidatosAlfa) {
+		numCandidatos = 2 * std::min(TSPsolverOpcao::NumCandidatosAlfa, this->numVertices - 1);
+		posicao = new int[this->numVertices];
+		for (int p = 0; p < this->numVertices; p++)
+			posicao[otimoLocal[p]] = p;
+	}
+
 	int i = -1;
 	while (numSubNeighborhoodsActive > 0) {
 		i = (i + 1) % this->numVertices;
@@ -428,45 +1008,48 @@ int* TSPsolver::fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcao
 
 		if (this->featureSubNeighborhoodActivation[cidadeAtualPercurso]) {
 			bool houveMelhora = false;
-			for (int j = 0; j < this->numVertices; j++) {
+			for (int j = 0; j < numCandidatos; j++) {
 				int indCidadeAtual = i;
-				int indCidadeParaTrocar = this->sucessor[i][j];
-				int cidadeParaTrocar = otimoLocal[indCidadeParaTrocar];
-				if (indCidadeParaTrocar == indCidadeAtual)
-					continue;
-				if ((indCidadeAtual == 0 && indCidadeParaTrocar == this->numVertices - 1) || (indCidadeAtual == this->numVertices - 1 && indCidadeParaTrocar == 0))
-					continue; // 2-opt vai gerar solução equivalente à inicial...
+				int indCidadeParaTrocar;
+				int cidadeParaTrocar;
+				if (usarCandidatosAlfa) {
+					// cada candidato é testado nos dois 2-opt que criam a aresta entre
+					// ele e a cidade atual: removendo as arestas para os sucessores
+					// (j par) ou para os antecessores (j ímpar) das duas cidades
+					cidadeParaTrocar = this->sucessor[cidadeAtualPercurso][j / 2];
+					int posCandidato = posicao[cidadeParaTrocar];
+					if (posCandidato == (i + 1) % this->numVertices || i == (posCandidato + 1) % this->numVertices)
+						continue; // já são vizinhos na rota
+					int deslocamento = (j % 2 == 0 ? 1 : 0);
+					indCidadeAtual = std::min(i, posCandidato) + deslocamento;
+					indCidadeParaTrocar = std::max(i, posCandidato) - 1 + deslocamento;
+					if (indCidadeAtual == 0 && indCidadeParaTrocar == this->numVertices - 1)
+						continue;
+				} else {
+					indCidadeParaTrocar = (usarOrdemAleatoria ? this->sortearCandidatoAleatorio(i, j) :
+							this->sucessor[i][j]);
+					cidadeParaTrocar = otimoLocal[indCidadeParaTrocar];
+					if (indCidadeParaTrocar == indCidadeAtual)
+						continue;
+					if ((indCidadeAtual == 0 && indCidadeParaTrocar == this->numVertices - 1) || (indCidadeAtual == this->numVertices - 1 && indCidadeParaTrocar == 0))
+						continue; // 2-opt vai gerar solução equivalente à inicial...
+				}
 				ajustaIndices(&indCidadeAtual, &indCidadeParaTrocar);
-				efetuar2opt(otimoLocal, novaSolucao, this->numVertices, indCidadeAtual, indCidadeParaTrocar);
-				int antecessorCidadeAtual = (indCidadeAtual > 0 ? indCidadeAtual - 1 : this->numVertices - 1);
-				int sucessorCidadeParaTrocar = (indCidadeParaTrocar + 1) % this->numVertices;
-				int arestaRemovida1Origem = otimoLocal[antecessorCidadeAtual];
-				int arestaRemovida1Destino = otimoLocal[indCidadeAtual];
-				int arestaRemovida2Origem = otimoLocal[indCidadeParaTrocar];
-				int arestaRemovida2Destino = otimoLocal[sucessorCidadeParaTrocar];
-				int arestaIncluida1Origem = arestaRemovida1Origem;
-				int arestaIncluida1Destino = arestaRemovida2Origem;
-				int arestaIncluida2Origem = arestaRemovida1Destino;
-				int arestaIncluida2Destino = arestaRemovida2Destino;
-				double custoArestaRemovida1 = this->obterPesoAresta(arestaRemovida1Origem, arestaRemovida1Destino);
-				double custoArestaRemovida2 = this->obterPesoAresta(arestaRemovida2Origem, arestaRemovida2Destino);
-				double custoArestaIncluida1 = this->obterPesoAresta(arestaIncluida1Origem, arestaIncluida1Destino);
-				double custoArestaIncluida2 = this->obterPesoAresta(arestaIncluida2Origem, arestaIncluida2Destino);
-				double custo = custoOtimoLocal - custoArestaRemovida1 - custoArestaRemovida2 + custoArestaIncluida1
-						+ custoArestaIncluida2;
-				double custoAumentado = custoAumentadoOtimoLocal - custoArestaRemovida1
-						- this->lambda * this->obterPenalidadeAresta(arestaRemovida1Origem, arestaRemovida1Destino)
-						- custoArestaRemovida2
-						- this->lambda * this->obterPenalidadeAresta(arestaRemovida2Origem, arestaRemovida2Destino)
-						+ custoArestaIncluida1
-						+ this->lambda * this->obterPenalidadeAresta(arestaIncluida1Origem, arestaIncluida1Destino)
-						+ custoArestaIncluida2
-						+ this->lambda * this->obterPenalidadeAresta(arestaIncluida2Origem, arestaIncluida2Destino);
-
-				if ((opcaoAprimorante == TSPsolverOpcao::OpcaoPrimeiroAprimorante &&
+				double custo, custoAumentado;
+				this->avaliarMovimento2opt(otimoLocal, indCidadeAtual, indCidadeParaTrocar, custoOtimoLocal,
+						custoAumentadoOtimoLocal, &custo, &custoAumentado);
+				if (!usarFuncaoCustoAumentada)
+					custoAumentado = custo;
+
+				bool aceito = (opcaoAprimorante == TSPsolverOpcao::OpcaoPrimeiroAprimorante &&
 						arredondar(custoAumentado, 4) < arredondar(custoAumentadoOtimoLocal, 4)) ||
 						(opcaoAprimorante == TSPsolverOpcao::OpcaoMelhorAprimorante &&
-						arredondar(custoAumentado, 4) < arredondar(custoAumentadoMelhorVizinho, 4))) {
+						arredondar(custoAumentado, 4) < arredondar(custoAumentadoMelhorVizinho, 4));
+				// o vizinho (cópia de N posições) só é montado se for guardado
+				if (aceito || custo < melhorCusto)
+					efetuar2opt(otimoLocal, novaSolucao, this->numVertices, indCidadeAtual, indCidadeParaTrocar);
+
+				if (aceito) {
 					if (opcaoAprimorante == TSPsolverOpcao::OpcaoPrimeiroAprimorante) {
 						copiarVetor(novaSolucao, otimoLocal, this->numVertices);
 						custoAumentadoOtimoLocal = custoAumentado;
@@ -484,6 +1067,13 @@ int* TSPsolver::fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcao
 						this->featureSubNeighborhoodActivation[cidadeParaTrocar] = true;
 						numSubNeighborhoodsActive++;
 					}
+					if (usarCandidatosAlfa) {
+						// e as das demais extremidades das arestas removidas
+						this->ativarSubVizinhanca(otimoLocal[(indCidadeAtual + this->numVertices - 1) % this->numVertices]);
+						this->ativarSubVizinhanca(otimoLocal[indCidadeAtual]);
+						this->ativarSubVizinhanca(otimoLocal[indCidadeParaTrocar]);
+						this->ativarSubVizinhanca(otimoLocal[(indCidadeParaTrocar + 1) % this->numVertices]);
+					}
 				}
 				if (custo < melhorCusto) {
 					copiarVetor(novaSolucao, melhorSolucao, this->numVertices);
@@ -492,10 +1082,10 @@ int* TSPsolver::fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcao
 				cont++;
 
 				if (houveMelhora && opcaoAprimorante == TSPsolverOpcao::OpcaoPrimeiroAprimorante) {
-					// atualizar ótimo local
-					copiarVetor(novaSolucao, otimoLocal, this->numVertices);
-					custoAumentadoOtimoLocal = custoAumentado;
-					custoOtimoLocal = custo;
+					// o ótimo local já foi atualizado acima
+					if (usarCandidatosAlfa)
+						for (int p = indCidadeAtual; p <= indCidadeParaTrocar; p++)
+							posicao[otimoLocal[p]] = p;
 
 					// backtrack one city
 					i--;
@@ -505,6 +1095,8 @@ int* TSPsolver::fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcao
 				}
 
 			}
+			if (usarOrdemAleatoria)
+				this->encerrarVarreduraAleatoria();
 			if (!houveMelhora) {
 				// desativar sub-vizinhança
 				this->featureSubNeighborhoodActivation[cidadeAtualPercurso] = false;
@@ -514,15 +1106,23 @@ int* TSPsolver::fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcao
 				copiarVetor(melhorVizinho, otimoLocal, this->numVertices);
 				custoAumentadoOtimoLocal = custoAumentadoMelhorVizinho;
 				custoOtimoLocal = custoMelhorVizinho;
+				if (usarCandidatosAlfa)
+					for (int p = 0; p < this->numVertices; p++)
+						posicao[otimoLocal[p]] = p;
 			}
 		}
 	}
-
-	std::printf("\n  - custo do ótimo local..........: %.1f\n", this->funcaoCustoSolucao(otimoLocal));
-	std::printf("  - custo aumentado do ótimo local: %.1f\n", custoAumentadoOtimoLocal);
-	std::printf("  - custo da melhor solução.......: %.1f\n", melhorCusto);
-	std::printf(" -> Fim de busca local.\n");
-	std::printf(" -> Soluções avaliadas: %d\n", cont);
+	delete[] posicao;
+	delete[] novaSolucao;
+	delete[] melhorVizinho;
+
+	if (this->verboso) {
+		std::printf("\n  - custo do ótimo local..........: %.1f\n", this->funcaoCustoSolucao(otimoLocal));
+		std::printf("  - custo aumentado do ótimo local: %.1f\n", custoAumentadoOtimoLocal);
+		std::printf("  - custo da melhor solução.......: %.1f\n", melhorCusto);
+		std::printf(" -> Fim de busca local.\n");
+		std::printf(" -> Soluções avaliadas: %d\n", cont);
+	}
 
 	return otimoLocal;
 }
@@ -535,24 +1135,189 @@ int TSPsolver::obterPenalidadeAresta(int origem, int destino) {
 	return this->penalidade[std::min(origem, destino)][std::max(origem, destino)];
 }
 
-int* TSPsolver::gerarSolucaoArbitraria() {
-	srand(time(NULL));
+// rota de partida das buscas: a definida por definirSolucaoInicial ou uma aleatória
+int* TSPsolver::obterSolucaoInicial() {
+	if (this->solucaoInicial == NULL)
+		return this->gerarSolucaoArbitraria();
 	int* solucao = new int[this->numVertices];
-	for (int i = 0; i < this->numVertices; i++)
-		solucao[i] = -1;
-	for (int i = 0; i < this->numVertices; i++) {
-		int r = rand() % this->numVertices;
-		if (solucao[r] == -1) // se posição r estiver livre, ocupe com i
-			solucao[r] = i;
-		else { // senão, busque a próxima posição livre a partir de r e ocupe com i
-			for (int j = 1; j < this->numVertices; j++) {
-				if (solucao[(r + j) % this->numVertices] == -1) {
-					solucao[(r + j) % this->numVertices] = i;
-					break;
+	copiarVetor(this->solucaoInicial, solucao, this->numVertices);
+	return solucao;
+}
+
+void TSPsolver::definirSolucaoInicial(int* rota) {
+	if (this->solucaoInicial == NULL)
+		this->solucaoInicial = new int[this->numVertices];
+	copiarVetor(rota, this->solucaoInicial, this->numVertices);
+}
+
+// partida aquecida a partir da rota de uma instância anterior, já escrita com os
+// índices desta instância: entradas -1 (ou repetidas) são cidades removidas e as
+// cidades que não aparecem são inseridas pela inserção mais barata.
+// cidadesAlteradas lista as cidades cujos pesos mudaram. Só as cidades afetadas
+// (inseridas, alteradas e vizinhas de inserções, remoções e alterações) têm a
+// sub-vizinhança ativada no início da busca.
+void TSPsolver::definirPartidaAquecida(int* rotaAnterior, int tamanhoRotaAnterior, int* cidadesAlteradas,
+		int numCidadesAlteradas) {
+	int n = this->numVertices;
+	std::vector<bool> afetada(n, false);
+	std::vector<bool> naRota(n, false);
+	std::vector<int> proximo(n, -1);
+
+	// manter as cidades que continuam na instância, ligando as vizinhas das removidas
+	int primeira = -1;
+	int anterior = -1;
+	bool houveRemocao = false;
+	bool remocaoNoInicio = false;
+	for (int k = 0; k < tamanhoRotaAnterior; k++) {
+		int c = rotaAnterior[k];
+		if (c < 0 || c >= n || naRota[c]) {
+			houveRemocao = true;
+			continue;
+		}
+		naRota[c] = true;
+		if (anterior == -1) {
+			primeira = c;
+			remocaoNoInicio = houveRemocao;
+		} else {
+			proximo[anterior] = c;
+			if (houveRemocao)
+				afetada[anterior] = afetada[c] = true;
+		}
+		anterior = c;
+		houveRemocao = false;
+	}
+	if (primeira != -1) {
+		proximo[anterior] = primeira;
+		if (houveRemocao || remocaoNoInicio)
+			afetada[anterior] = afetada[primeira] = true;
+	}
+
+	// inserção mais barata das cidades novas
+	int numNaRota = 0;
+	for (int c = 0; c < n; c++)
+		if (naRota[c])
+			numNaRota++;
+	for (int c = 0; c < n; c++) {
+		if (naRota[c])
+			continue;
+		afetada[c] = true;
+		if (numNaRota == 0) {
+			primeira = c;
+			proximo[c] = c;
+		} else {
+			int melhorU = primeira;
+			double melhorAcrescimo = DBL_MAX;
+			int u = primeira;
+			do {
+				int v = proximo[u];
+				double acrescimo = (u == v ? 2 * this->obterPesoAresta(u, c) :
+						this->obterPesoAresta(u, c) + this->obterPesoAresta(c, v) - this->obterPesoAresta(u, v));
+				if (acrescimo < melhorAcrescimo) {
+					melhorAcrescimo = acrescimo;
+					melhorU = u;
 				}
+				u = v;
+			} while (u != primeira);
+			proximo[c] = proximo[melhorU];
+			proximo[melhorU] = c;
+			afetada[melhorU] = afetada[proximo[c]] = true;
+		}
+		naRota[c] = true;
+		numNaRota++;
+	}
+
+	int* rota = new int[n];
+	int c = primeira;
+	for (int k = 0; k < n; k++) {
+		rota[k] = c;
+		c = proximo[c];
+	}
+	// cidades com pesos alterados e suas vizinhas na rota
+	for (int k = 0; k < numCidadesAlteradas; k++) {
+		int alterada = cidadesAlteradas[k];
+		if (alterada >= 0 && alterada < n)
+			afetada[alterada] = true;
+	}
+	std::vector<bool> vizinhaDeAlterada(n, false);
+	if (numCidadesAlteradas > 0) {
+		std::vector<int> posicao(n);
+		for (int pos = 0; pos < n; pos++)
+			posicao[rota[pos]] = pos;
+		for (int k = 0; k < numCidadesAlteradas; k++) {
+			int alterada = cidadesAlteradas[k];
+			if (alterada < 0 || alterada >= n)
+				continue;
+			vizinhaDeAlterada[rota[(posicao[alterada] + n - 1) % n]] = true;
+			vizinhaDeAlterada[rota[(posicao[alterada] + 1) % n]] = true;
+		}
+	}
+
+	this->cidadesAfetadas.clear();
+	for (int c = 0; c < n; c++)
+		if (afetada[c] || vizinhaDeAlterada[c])
+			this->cidadesAfetadas.push_back(c);
+	this->partidaAquecida = true;
+	this->definirSolucaoInicial(rota);
+	delete[] rota;
+
+	if (this->verboso)
+		std::printf("Partida aquecida: %d cidades afetadas, custo reparado %.1f\n",
+				(int) this->cidadesAfetadas.size(), this->funcaoCustoSolucao(this->solucaoInicial));
+}
+
+// penalidades esparsas de uma execução anterior, retomadas em vez de zeradas
+void TSPsolver::definirPenalidadesAnteriores(int numArestas, int* origem, int* destino, int* valor) {
+	for (int i = 0; i < this->numVertices - 1; i++)
+		for (int j = 0; j < this->numVertices; j++)
+			this->penalidade[i][j] = 0;
+	for (int a = 0; a < numArestas; a++) {
+		int atual = origem[a];
+		int sucessor = destino[a];
+		if (atual == sucessor || atual < 0 || sucessor < 0 || atual >= this->numVertices
+				|| sucessor >= this->numVertices)
+			continue;
+		ajustaIndices(&atual, &sucessor);
+		this->penalidade[atual][sucessor] = valor[a];
+	}
+	this->manterPenalidades = true;
+}
+
+int TSPsolver::contarPenalidadesNaoNulas() {
+	int cont = 0;
+	for (int i = 0; i < this->numVertices - 1; i++)
+		for (int j = i + 1; j < this->numVertices; j++)
+			if (this->penalidade[i][j] != 0)
+				cont++;
+	return cont;
+}
+
+// arestas com penalidade não nula (i < j); os vetores devem ter
+// contarPenalidadesNaoNulas() posições
+void TSPsolver::obterPenalidades(int* origem, int* destino, int* valor) {
+	int a = 0;
+	for (int i = 0; i < this->numVertices - 1; i++) {
+		for (int j = i + 1; j < this->numVertices; j++) {
+			if (this->penalidade[i][j] != 0) {
+				origem[a] = i;
+				destino[a] = j;
+				valor[a] = this->penalidade[i][j];
+				a++;
 			}
 		}
 	}
+}
+
+int* TSPsolver::gerarSolucaoArbitraria() {
+	int* solucao = new int[this->numVertices];
+	for (int i = 0; i < this->numVertices; i++)
+		solucao[i] = i;
+	// permutação aleatória (Fisher-Yates)
+	for (int i = this->numVertices - 1; i > 0; i--) {
+		int r = this->gerador.inteiro(i + 1);
+		int temp = solucao[i];
+		solucao[i] = solucao[r];
+		solucao[r] = temp;
+	}
 
 	return solucao;
 }
@@ -8,22 +8,68 @@
 #ifndef TSPSOLVER_H_
 #define TSPSOLVER_H_
 
+#include <chrono>
 #include <string>
+#include <vector>
+
+#include "GeradorAleatorio.h"
+#include "GravadorAssincrono.h"
+#include "LimiteInferior.h"
 
 namespace TSPsolverOpcao {
 	const int OpcaoBuscaLocalConvencional = 0;
 	const int OpcaoBuscaLocalRapidaArestasAleatorias = 1;
 	const int OpcaoBuscaLocalRapidaArestasMenoresPrimeiro = 2;
 	const int OpcaoBuscaLocalRapidaArestasMaioresPrimeiro = 3;
+	const int OpcaoBuscaLocalRapidaArestasAlfa = 4;
 	const std::string StrOpcaoBuscaLocalConvencional = "BLC";
 	const std::string StrOpcaoBuscaLocalRapidaArestasAleatorias = "BLRAle";
 	const std::string StrOpcaoBuscaLocalRapidaArestasMenoresPrimeiro = "BLRMen";
 	const std::string StrOpcaoBuscaLocalRapidaArestasMaioresPrimeiro = "BLRMai";
+	const std::string StrOpcaoBuscaLocalRapidaArestasAlfa = "BLRAlfa";
+
+	const int NumCandidatosLimiteInferior = 10;
+	// candidatos por cidade examinados pela busca local na ordem por alfa
+	const int NumCandidatosAlfa = 8;
+	const int MaxIteracoesLimiteInferior = 1000;
+
+	const int OpcaoMetaheuristicaGLS = 0;
+	const int OpcaoMetaheuristicaILS = 1;
+	const int OpcaoMetaheuristicaGLSComChute = 2;
+	const int OpcaoMetaheuristicaDecomposicao = 3;
+	const std::string StrOpcaoMetaheuristicaGLS = "GLS";
+	const std::string StrOpcaoMetaheuristicaILS = "ILS";
+	const std::string StrOpcaoMetaheuristicaGLSComChute = "GLSChute";
+	const std::string StrOpcaoMetaheuristicaDecomposicao = "DEC";
+
+	// chute double-bridge: tamanho da janela e estagnação da GLS que o dispara
+	const int TamanhoJanelaChute = 50;
+	const int IteracoesSemMelhoraChute = 100;
+
+	// decomposição espacial: rodadas, cidades por região (k-means) e menor
+	// trecho de rota que vale a pena otimizar
+	const int RodadasDecomposicao = 10;
+	const int TamanhoRegiaoDecomposicao = 250;
+	const int TamanhoMinimoTrechoDecomposicao = 8;
 
 	const int OpcaoPrimeiroAprimorante = 0;
 	const int OpcaoMelhorAprimorante = 1;
 }
 
+void efetuar2opt(int* rota, int* novaRota, int numVertices, int i, int j);
+
+// estado de um laço de busca no início de uma iteração, além do que o próprio
+// solver guarda (penalidades, lambda, gerador e sub-vizinhanças ativas)
+struct EstadoBusca {
+	int k;
+	int* solucaoAtual;
+	int* melhorSolucao;
+	double melhorCusto;
+	int iteracoesSemMelhora; // GLS com chute
+	int aceitas;             // ILS
+	int melhorias;           // iterações que melhoraram a melhor solução
+};
+
 class TSPsolver {
 private:
 	int numVertices;
@@ -35,23 +81,75 @@ private:
 	int numSubNeighborhoodsActive;
 	int** sucessor;
 	int opcao;
+	bool verboso;
+	GeradorAleatorio gerador;
+	LimiteInferior* limiteInferior;
+	double gapParada;
+	int metaheuristica;
+	int* solucaoInicial;
+	bool partidaAquecida;
+	bool manterPenalidades;
+	std::vector<int> cidadesAfetadas;
+	std::string arquivoCheckpoint;
+	int intervaloCheckpoint;
+	std::string arquivoRetomada;
+	int iteracaoRetomada;
+	GravadorAssincrono* gravador;
+	uint64_t sementeOrdemAleatoria;
+	int* varreduras;
+	int* trocasVarredura;
+	std::vector<int> posicoesTrocadas;
+	uint64_t chaveVarredura;
+	void alocarMatrizSucessores();
+	void atualizarMatrizSucessores();
+	void ativarSubVizinhanca(int cidade);
+	void inicializarSubVizinhancas();
+	void inicializarPenalidades();
+	void relatarMelhorias(const std::string& modo, int melhorias, int iteracoes, double segundos);
+	bool checkpointDevido(int k);
+	void salvarCheckpoint(EstadoBusca* estado);
+	bool carregarCheckpoint(EstadoBusca* estado);
+	void aguardarCheckpoint();
+	bool atingiuGapParada(int* melhorSolucao);
 public:
-	TSPsolver(int nv, double** c, double lambda, int iteracoes, int opcao);
+	TSPsolver(int nv, double** c, double lambda, int iteracoes, int opcao, uint64_t semente);
 	double funcaoCustoSolucao(int* solucao);
 	double funcaoCustoSolucaoAumentada(int* solucao);
 	double expressaoUtilidade(int* solucao, int indCaracteristica);
+	void penalizarArestasUtilidadeMaxima(int* solucao, double* util, bool ativarSubVizinhancas);
+	void avaliarMovimento2opt(int* rota, int i, int j, double custoRota, double custoAumentadoRota,
+			double* custo, double* custoAumentado);
 	int* resolver();
 	int* guidedLocalSearch();
 	int* guidedLocalSearchWithFastLocalSearch();
+	int* iteratedLocalSearch();
+	void aplicarChuteDoubleBridge(int* rota);
 	int* localSearch(int* solucaoAtual, int* melhorSolucao,
 			bool usarFuncaoCustoAumentada);
 	int* fastLocalSearch(int* solucaoAtual, int* melhorSolucao, int opcaoAprimorante,
 			bool usarFuncaoCustoAumentada);
 	int* gerarSolucaoArbitraria();
+	int* obterSolucaoInicial();
+	void definirSolucaoInicial(int* rota);
+	void definirPartidaAquecida(int* rotaAnterior, int tamanhoRotaAnterior, int* cidadesAlteradas,
+			int numCidadesAlteradas);
+	void definirPenalidadesAnteriores(int numArestas, int* origem, int* destino, int* valor);
+	int contarPenalidadesNaoNulas();
+	void obterPenalidades(int* origem, int* destino, int* valor);
 	double obterPesoAresta(int origem, int destino);
 	int obterPenalidadeAresta(int origem, int destino);
 	void calcularMatrizSucessoresOrdenada(bool ordemCrescente);
-	void calcularMatrizSucessoresAleatoria();
+	void calcularMatrizSucessoresAlfa();
+	void prepararMatrizSucessores();
+	int sortearCandidatoAleatorio(int linha, int j);
+	void encerrarVarreduraAleatoria();
+	double calcularLimiteInferior(double limiteSuperior);
+	double obterLimiteInferior();
+	void definirGapParada(double gapPercentual);
+	void definirMetaheuristica(int metaheuristica);
+	void definirCheckpoint(const std::string& arquivo, int intervalo);
+	void definirRetomada(const std::string& arquivo);
+	void definirVerbosidade(bool verboso);
 	virtual ~TSPsolver();
 };
 
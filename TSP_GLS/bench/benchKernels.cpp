@@ -0,0 +1,303 @@
+/*
+ * benchKernels.cpp
+ *
+ *  Microbenchmark dos núcleos da busca (2-opt, funções de custo, matriz de
+ *  sucessores, sorteio da ordem aleatória, utilidade e atualização de
+ *  penalidades) sobre instâncias sintéticas uniformes e agrupadas.
+ *
+ *  Os núcleos do solver precisam das matrizes densas N x N e são omitidos
+ *  acima do limite de memória: com o padrão (-m 2048) todos rodam até
+ *  n = 10000 (~1,9 GB); em n = 100000 (~190 GB) só efetuar2opt roda.
+ *
+ *  Uso: benchKernels [-n 100,1000,10000,100000] [-t segundos] [-m MB] [-s semente]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <time.h>
+
+#include "../TSPsolver.h"
+#include "../LimiteInferior.h"
+
+namespace {
+
+const int TipoUniforme = 0;
+const int TipoAgrupado = 1;
+const char* NomeTipo[] = { "uniforme", "agrupado" };
+
+// tamanho máximo para o cálculo da matriz de sucessores ordenada, que é O(n^3)
+const int MaxVerticesSucessoresOrdenada = 1000;
+
+volatile double sumidouro = 0;
+
+double agora() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void gerarCoordenadas(int n, int tipo, GeradorAleatorio* g, double** coord) {
+	if (tipo == TipoUniforme) {
+		for (int i = 0; i < n; i++) {
+			coord[i][0] = 1000 * g->uniforme();
+			coord[i][1] = 1000 * g->uniforme();
+		}
+		return;
+	}
+	// agrupado: n / 100 centros, pontos com dispersão normal em torno de cada um
+	int numGrupos = std::max(1, n / 100);
+	std::vector<double> cx(numGrupos), cy(numGrupos);
+	for (int c = 0; c < numGrupos; c++) {
+		cx[c] = 1000 * g->uniforme();
+		cy[c] = 1000 * g->uniforme();
+	}
+	for (int i = 0; i < n; i++) {
+		int c = g->inteiro(numGrupos);
+		double u1 = std::max(g->uniforme(), 1e-12);
+		double u2 = g->uniforme();
+		double r = 20 * sqrt(-2 * log(u1));
+		coord[i][0] = cx[c] + r * cos(2 * M_PI * u2);
+		coord[i][1] = cy[c] + r * sin(2 * M_PI * u2);
+	}
+}
+
+struct Contexto {
+	int n;
+	int* rota;
+	int* novaRota;
+	double* util;
+	TSPsolver* solver;
+	GeradorAleatorio* g;
+	double** pesos;
+};
+
+typedef void (*FuncaoNucleo)(Contexto* ctx, long repeticoes);
+
+void nucleoEfetuar2opt(Contexto* ctx, long repeticoes) {
+	for (long r = 0; r < repeticoes; r++) {
+		int i = ctx->g->inteiro(ctx->n - 1);
+		int j = i + 1 + ctx->g->inteiro(ctx->n - 1 - i);
+		efetuar2opt(ctx->rota, ctx->novaRota, ctx->n, i, j);
+		std::swap(ctx->rota, ctx->novaRota);
+	}
+	sumidouro = sumidouro + ctx->rota[0];
+}
+
+void nucleoCusto(Contexto* ctx, long repeticoes) {
+	double s = 0;
+	for (long r = 0; r < repeticoes; r++)
+		s += ctx->solver->funcaoCustoSolucao(ctx->rota);
+	sumidouro = sumidouro + s;
+}
+
+void nucleoCustoAumentado(Contexto* ctx, long repeticoes) {
+	double s = 0;
+	for (long r = 0; r < repeticoes; r++)
+		s += ctx->solver->funcaoCustoSolucaoAumentada(ctx->rota);
+	sumidouro = sumidouro + s;
+}
+
+void nucleoDelta2opt(Contexto* ctx, long repeticoes) {
+	double s = 0;
+	double custo, custoAumentado;
+	for (long r = 0; r < repeticoes; r++) {
+		int i = ctx->g->inteiro(ctx->n - 1);
+		int j = i + 1 + ctx->g->inteiro(ctx->n - 1 - i);
+		ctx->solver->avaliarMovimento2opt(ctx->rota, i, j, 0, 0, &custo, &custoAumentado);
+		s += custoAumentado;
+	}
+	sumidouro = sumidouro + s;
+}
+
+void nucleoUtilidade(Contexto* ctx, long repeticoes) {
+	double s = 0;
+	for (long r = 0; r < repeticoes; r++)
+		s += ctx->solver->expressaoUtilidade(ctx->rota, (int) (r % ctx->n));
+	sumidouro = sumidouro + s;
+}
+
+void nucleoPenalidades(Contexto* ctx, long repeticoes) {
+	for (long r = 0; r < repeticoes; r++)
+		ctx->solver->penalizarArestasUtilidadeMaxima(ctx->rota, ctx->util, false);
+	sumidouro = sumidouro + ctx->util[0];
+}
+
+void nucleoSucessoresOrdenada(Contexto* ctx, long repeticoes) {
+	for (long r = 0; r < repeticoes; r++)
+		ctx->solver->calcularMatrizSucessoresOrdenada(true);
+}
+
+// uma varredura completa de uma linha na ordem aleatória, como a busca local
+// rápida a faz quando nenhum candidato melhora
+void nucleoVarreduraAleatoria(Contexto* ctx, long repeticoes) {
+	long s = 0;
+	for (long r = 0; r < repeticoes; r++) {
+		int linha = (int) (r % ctx->n);
+		for (int j = 0; j < ctx->n; j++)
+			s += ctx->solver->sortearCandidatoAleatorio(linha, j);
+		ctx->solver->encerrarVarreduraAleatoria();
+	}
+	sumidouro = sumidouro + s;
+}
+
+void nucleoLimiteInferior(Contexto* ctx, long repeticoes) {
+	for (long r = 0; r < repeticoes; r++) {
+		LimiteInferior limite(ctx->n, ctx->pesos, TSPsolverOpcao::NumCandidatosLimiteInferior);
+		sumidouro = sumidouro + limite.calcular(0, 100);
+	}
+}
+
+void nucleoChute(Contexto* ctx, long repeticoes) {
+	for (long r = 0; r < repeticoes; r++)
+		ctx->solver->aplicarChuteDoubleBridge(ctx->rota);
+	sumidouro = sumidouro + ctx->rota[0];
+}
+
+// executa o núcleo dobrando as repetições até ocupar tempoMinimo; devolve ns/op
+double medir(FuncaoNucleo nucleo, Contexto* ctx, double tempoMinimo) {
+	long repeticoes = 1;
+	while (true) {
+		double inicio = agora();
+		nucleo(ctx, repeticoes);
+		double decorrido = agora() - inicio;
+		if (decorrido >= tempoMinimo || repeticoes >= (1L << 40))
+			return decorrido * 1e9 / repeticoes;
+		if (decorrido <= 0)
+			repeticoes *= 16;
+		else
+			repeticoes = (long) (repeticoes * std::min(16.0, 1.2 * tempoMinimo / decorrido)) + 1;
+	}
+}
+
+void relatar(const char* nucleo, int tipo, int n, const char* unidade, double nsPorOp, double bytesPorOp) {
+	double opsPorSegundo = 1e9 / nsPorOp;
+	std::printf("%-28s %-9s %8d %14.1f %14.4g %-7s %14.4g %10.2f\n", nucleo, NomeTipo[tipo], n, nsPorOp,
+			opsPorSegundo, unidade, bytesPorOp, bytesPorOp / nsPorOp);
+	std::fflush(stdout);
+}
+
+std::vector<int> lerTamanhos(const char* s) {
+	std::vector<int> tamanhos;
+	std::stringstream ss(s);
+	std::string item;
+	while (getline(ss, item, ','))
+		if (item != "")
+			tamanhos.push_back(atoi(item.c_str()));
+	return tamanhos;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<int> tamanhos = lerTamanhos("100,1000,10000,100000");
+	double tempoMinimo = 0.2;
+	double limiteMB = 2048;
+	uint64_t semente = 12345;
+
+	for (int a = 1; a + 1 < argc; a += 2) {
+		if (strcmp(argv[a], "-n") == 0)
+			tamanhos = lerTamanhos(argv[a + 1]);
+		else if (strcmp(argv[a], "-t") == 0)
+			tempoMinimo = atof(argv[a + 1]);
+		else if (strcmp(argv[a], "-m") == 0)
+			limiteMB = atof(argv[a + 1]);
+		else if (strcmp(argv[a], "-s") == 0)
+			semente = strtoull(argv[a + 1], NULL, 10);
+	}
+
+	std::printf("%-28s %-9s %8s %14s %14s %-7s %14s %10s\n", "nucleo", "instancia", "n", "ns/op", "taxa",
+			"unidade", "bytes/op", "GB/s");
+
+	for (unsigned int t = 0; t < tamanhos.size(); t++) {
+		int n = tamanhos[t];
+		if (n < 4)
+			continue;
+		for (int tipo = TipoUniforme; tipo <= TipoAgrupado; tipo++) {
+			GeradorAleatorio g(semente + n * 2 + tipo);
+			Contexto ctx;
+			ctx.n = n;
+			ctx.g = &g;
+			ctx.rota = new int[n];
+			ctx.novaRota = new int[n];
+			ctx.util = new double[n];
+			ctx.solver = NULL;
+			for (int i = 0; i < n; i++)
+				ctx.rota[i] = i;
+			for (int i = n - 1; i > 0; i--)
+				std::swap(ctx.rota[i], ctx.rota[g.inteiro(i + 1)]);
+
+			relatar("efetuar2opt", tipo, n, "mov/s", medir(nucleoEfetuar2opt, &ctx, tempoMinimo),
+					2.0 * n * sizeof(int));
+
+			// matriz de pesos da instância, cópia e penalidades do solver e, se
+			// calculada, a matriz de sucessores ordenada
+			double bytesPorPar = 2.0 * sizeof(double) + sizeof(int);
+			if (n <= MaxVerticesSucessoresOrdenada)
+				bytesPorPar += sizeof(int);
+			double mb = bytesPorPar * n * (double) n / (1024 * 1024);
+			if (mb > limiteMB) {
+				std::printf("%-28s %-9s %8d   (omitido: ~%.0f MB de matrizes, limite -m %.0f)\n", "nucleos do solver",
+						NomeTipo[tipo], n, mb, limiteMB);
+			} else {
+				double** coord = new double*[n];
+				for (int i = 0; i < n; i++)
+					coord[i] = new double[2];
+				gerarCoordenadas(n, tipo, &g, coord);
+				double** pesos = new double*[n];
+				for (int i = 0; i < n; i++) {
+					pesos[i] = new double[n];
+					for (int j = i + 1; j < n; j++)
+						pesos[i][j] = sqrt(pow(coord[j][0] - coord[i][0], 2) + pow(coord[j][1] - coord[i][1], 2));
+				}
+				for (int i = 0; i < n; i++)
+					delete[] coord[i];
+				delete[] coord;
+
+				ctx.solver = new TSPsolver(n, pesos, 1.0, 0,
+						TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasAleatorias, semente);
+				ctx.solver->definirVerbosidade(false);
+				ctx.solver->prepararMatrizSucessores();
+
+				relatar("funcaoCustoSolucao", tipo, n, "op/s", medir(nucleoCusto, &ctx, tempoMinimo),
+						n * (double) (sizeof(int) + sizeof(double)));
+				relatar("funcaoCustoSolucaoAumentada", tipo, n, "op/s", medir(nucleoCustoAumentado, &ctx, tempoMinimo),
+						n * (double) (2 * sizeof(int) + sizeof(double)));
+				relatar("delta 2-opt", tipo, n, "mov/s", medir(nucleoDelta2opt, &ctx, tempoMinimo),
+						4.0 * (2 * sizeof(int) + sizeof(double)));
+				relatar("expressaoUtilidade", tipo, n, "op/s", medir(nucleoUtilidade, &ctx, tempoMinimo),
+						2.0 * sizeof(int) + sizeof(double) + sizeof(int));
+				relatar("atualizacao penalidades", tipo, n, "op/s", medir(nucleoPenalidades, &ctx, tempoMinimo),
+						n * (double) (2 * sizeof(int) + 2 * sizeof(double)));
+				relatar("chute double-bridge", tipo, n, "mov/s", medir(nucleoChute, &ctx, tempoMinimo),
+						4.0 * TSPsolverOpcao::TamanhoJanelaChute / 2 * sizeof(int));
+				relatar("varredura aleatoria", tipo, n, "op/s", medir(nucleoVarreduraAleatoria, &ctx, tempoMinimo),
+						2.0 * n * sizeof(int));
+				if (n <= MaxVerticesSucessoresOrdenada)
+					relatar("sucessoresOrdenada", tipo, n, "op/s",
+							medir(nucleoSucessoresOrdenada, &ctx, tempoMinimo),
+							0.5 * n * (double) n * n * (2 * sizeof(int) + sizeof(double)));
+
+				ctx.pesos = pesos;
+				relatar("limite Held-Karp (100 it.)", tipo, n, "op/s", medir(nucleoLimiteInferior, &ctx, tempoMinimo),
+						100.0 * n * TSPsolverOpcao::NumCandidatosLimiteInferior * (sizeof(int) + sizeof(double)));
+
+				delete ctx.solver;
+				for (int i = 0; i < n; i++)
+					delete[] pesos[i];
+				delete[] pesos;
+			}
+
+			delete[] ctx.rota;
+			delete[] ctx.novaRota;
+			delete[] ctx.util;
+		}
+	}
+
+	return 0;
+}
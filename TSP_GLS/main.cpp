@@ -21,11 +21,18 @@
 #include <sys/time.h>
 
 #include "TSPsolver.h"
+#include "DecomposicaoEspacial.h"
 
 double get_cpu_time(){
     return (double)clock() / CLOCKS_PER_SEC;
 }
 
+double get_wall_time(){
+    struct timeval time;
+    gettimeofday(&time, NULL);
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
+
 // trim from start
 static inline std::string &ltrim(std::string &s) {
     s.erase(s.begin(), std::find_if(s.begin(), s.end(),
@@ -78,7 +85,7 @@ double calcularDistancia(double x1, double y1, double x2, double y2) {
 	return dist;
 }
 
-void lerCoordenadas(std::ifstream* arqInstancia, int numCidades, double** pesos) {
+double** lerCoordenadas(std::ifstream* arqInstancia, int numCidades) {
 	std::string linha;
 	double** coord = new double*[numCidades];
 	for (int i = 0; i < numCidades; i++)
@@ -89,6 +96,10 @@ void lerCoordenadas(std::ifstream* arqInstancia, int numCidades, double** pesos)
 		coord[i][0] = atof(snums[1].c_str());
 		coord[i][1] = atof(snums[2].c_str());
 	}
+	return coord;
+}
+
+void calcularPesos(int numCidades, double** coord, double** pesos) {
 	// calcular os pesos (distâncias entre as cidades)
 	for (int i = 0; i < numCidades - 1; i++) {
 		for (int j = i + 1; j < numCidades; j++) {
@@ -98,6 +109,44 @@ void lerCoordenadas(std::ifstream* arqInstancia, int numCidades, double** pesos)
 	}
 }
 
+double** alocarMatriz(int numCidades) {
+	double** pesos = new double*[numCidades];
+	for (int i = 0; i < numCidades; i++)
+		pesos[i] = new double[numCidades];
+	return pesos;
+}
+
+// rota de uma execução anterior para a partida aquecida, com a numeração (a partir
+// de 1) da instância atual: aceita a linha "Melhor rota encontrada" impressa por
+// este programa ou um arquivo .tour do TSPLIB. 0 marca uma cidade removida
+bool lerRotaAnterior(const std::string& nomeArq, std::vector<int>* rota) {
+	std::ifstream arq(nomeArq.c_str());
+	if (!arq.is_open())
+		return false;
+	rota->clear();
+	bool secaoTsplib = false;
+	std::string linha;
+	while (getline(arq, linha)) {
+		if (linha.substr(0, 12) == "TOUR_SECTION") {
+			rota->clear();
+			secaoTsplib = true;
+			continue;
+		}
+		std::replace(linha.begin(), linha.end(), ',', ' ');
+		std::vector<std::string> snums = split(trim(linha), ' ');
+		for (unsigned int k = 0; k < snums.size(); k++) {
+			char* fim;
+			long cidade = strtol(snums[k].c_str(), &fim, 10);
+			if (*fim != '\0')
+				continue; // cabeçalho ou texto
+			if (secaoTsplib && cidade == -1)
+				return true;
+			rota->push_back(cidade > 0 ? (int) cidade - 1 : -1);
+		}
+	}
+	return true;
+}
+
 void imprimirPesos(int numCidades, double** pesos) {
 	for (int i = 0; i < numCidades; i++) {
 		for (int j = 0; j < numCidades; j++) {
@@ -108,7 +157,39 @@ void imprimirPesos(int numCidades, double** pesos) {
 }
 
 int main(int argc, char* argv[]) {
-	if (argc == 5) {
+	double inicioRelogio = get_wall_time();
+
+	// opções de checkpoint em qualquer posição; o restante são os parâmetros posicionais
+	std::string arquivoCheckpoint = "", arquivoRetomada = "";
+	int intervaloCheckpoint = 0;
+	int numThreads = 0;
+	std::string arquivoRotaAnterior = "";
+	std::vector<int> cidadesAlteradas;
+	std::vector<char*> parametros;
+	for (int i = 0; i < argc; i++) {
+		std::string arg = std::string(argv[i]);
+		if (arg.substr(0, 13) == "--checkpoint=")
+			arquivoCheckpoint = arg.substr(13);
+		else if (arg.substr(0, 12) == "--intervalo=")
+			intervaloCheckpoint = atoi(arg.substr(12).c_str());
+		else if (arg.substr(0, 10) == "--retomar=")
+			arquivoRetomada = arg.substr(10);
+		else if (arg.substr(0, 10) == "--threads=")
+			numThreads = atoi(arg.substr(10).c_str());
+		else if (arg.substr(0, 16) == "--rota-anterior=")
+			arquivoRotaAnterior = arg.substr(16);
+		else if (arg.substr(0, 12) == "--alteradas=") {
+			std::vector<std::string> scidades = split(arg.substr(12), ',');
+			for (unsigned int k = 0; k < scidades.size(); k++)
+				cidadesAlteradas.push_back(atoi(scidades[k].c_str()) - 1);
+		}
+		else
+			parametros.push_back(argv[i]);
+	}
+	argc = (int) parametros.size();
+	argv = parametros.data();
+
+	if (argc >= 5 && argc <= 8) {
 		double lambda = atof(argv[1]);
 		char* nomeArqInstancia = argv[2];
 		std::printf("%s\n", nomeArqInstancia);
@@ -123,56 +204,119 @@ int main(int argc, char* argv[]) {
 			opcao = TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasMaioresPrimeiro;
 		else if (nomeMetodoBL == TSPsolverOpcao::StrOpcaoBuscaLocalRapidaArestasMenoresPrimeiro)
 			opcao = TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasMenoresPrimeiro;
+		else if (nomeMetodoBL == TSPsolverOpcao::StrOpcaoBuscaLocalRapidaArestasAlfa)
+			opcao = TSPsolverOpcao::OpcaoBuscaLocalRapidaArestasAlfa;
 
 		std::ifstream arqInstancia(nomeArqInstancia);
 		int numIteracoes = atoi(argv[4]);
+		// semente opcional; sem ela, cada execução usa o relógio
+		uint64_t semente = (argc >= 6 ? strtoull(argv[5], NULL, 10) : (uint64_t) time(NULL));
+		std::printf("Semente: %llu\n", (unsigned long long) semente);
+		// gap (%) em relação ao limite inferior de Held-Karp para interromper a busca
+		double gapParada = (argc >= 7 ? atof(argv[6]) : 0);
+
+		int metaheuristica = TSPsolverOpcao::OpcaoMetaheuristicaGLS;
+		if (argc == 8) {
+			std::string nomeMetaheuristica = std::string(argv[7]);
+			if (nomeMetaheuristica == TSPsolverOpcao::StrOpcaoMetaheuristicaILS)
+				metaheuristica = TSPsolverOpcao::OpcaoMetaheuristicaILS;
+			else if (nomeMetaheuristica == TSPsolverOpcao::StrOpcaoMetaheuristicaGLSComChute)
+				metaheuristica = TSPsolverOpcao::OpcaoMetaheuristicaGLSComChute;
+			else if (nomeMetaheuristica == TSPsolverOpcao::StrOpcaoMetaheuristicaDecomposicao)
+				metaheuristica = TSPsolverOpcao::OpcaoMetaheuristicaDecomposicao;
+		}
 
 		if (arqInstancia.is_open()) {
 			std::string linha = "";
 			int numCidades = 0;
 			int estado = 0;
-			double** pesos;
+			double** pesos = NULL;
+			double** coord = NULL;
 			while (getline(arqInstancia, linha)) {
 				switch (estado) {
 				case 0: // procurando número de cidades (dimensão)
 					if (linha.substr(0, 9) == "DIMENSION") {
 						std::string sDim = linha.substr(11);
 						numCidades = atoi(sDim.c_str());
-						pesos = new double*[numCidades];
-						for (int i = 0; i < numCidades; i++)
-							pesos[i] = new double[numCidades];
 						estado = 1;
 					}
 					break;
 				case 1: // procurando seção de pesos ou de coordenadas
 					if (linha.substr(0, 19) == "EDGE_WEIGHT_SECTION") {
+						pesos = alocarMatriz(numCidades);
 						lerMatrizDePesos(&arqInstancia, numCidades, pesos);
 					} else if (linha.substr(0, 18) == "NODE_COORD_SECTION") {
-						lerCoordenadas(&arqInstancia, numCidades, pesos);
+						coord = lerCoordenadas(&arqInstancia, numCidades);
 					}
 					break;
 				}
 			}
-			imprimirPesos(numCidades, pesos);
 			arqInstancia.close();
 
-			TSPsolver* tspSolver = new TSPsolver(numCidades, pesos, lambda, numIteracoes, opcao);
-			int* rota = tspSolver->resolver();
+			int* rota;
+			double custo;
+			if (metaheuristica == TSPsolverOpcao::OpcaoMetaheuristicaDecomposicao && coord != NULL) {
+				// decomposição espacial: trabalha só com as coordenadas, sem a matriz N x N
+				if (gapParada > 0)
+					printf("Gap de parada não se aplica à decomposição espacial; ignorado.\n");
+				if (!arquivoCheckpoint.empty() || !arquivoRetomada.empty())
+					printf("Checkpoint e retomada não se aplicam à decomposição espacial; ignorados.\n");
+				if (!arquivoRotaAnterior.empty())
+					printf("Partida aquecida não se aplica à decomposição espacial; ignorada.\n");
+				DecomposicaoEspacial* decomposicao = new DecomposicaoEspacial(numCidades, coord, lambda, numIteracoes,
+						opcao, semente);
+				if (numThreads > 0)
+					decomposicao->definirNumThreads(numThreads);
+				rota = decomposicao->resolver(TSPsolverOpcao::RodadasDecomposicao, NULL);
+				custo = decomposicao->custoRota(rota);
+			} else {
+				if (metaheuristica == TSPsolverOpcao::OpcaoMetaheuristicaDecomposicao)
+					printf("Decomposição espacial requer coordenadas; usando GLS.\n");
+				if (numThreads > 0)
+					printf("Número de threads só se aplica à decomposição espacial; ignorado.\n");
+				if (pesos == NULL) {
+					pesos = alocarMatriz(numCidades);
+					calcularPesos(numCidades, coord, pesos);
+				}
+				imprimirPesos(numCidades, pesos);
+
+				TSPsolver* tspSolver = new TSPsolver(numCidades, pesos, lambda, numIteracoes, opcao, semente);
+				tspSolver->definirGapParada(gapParada);
+				tspSolver->definirMetaheuristica(metaheuristica);
+				if (!arquivoCheckpoint.empty())
+					tspSolver->definirCheckpoint(arquivoCheckpoint, (intervaloCheckpoint > 0 ? intervaloCheckpoint : 1000));
+				if (!arquivoRetomada.empty())
+					tspSolver->definirRetomada(arquivoRetomada);
+				if (!arquivoRotaAnterior.empty()) {
+					std::vector<int> rotaAnterior;
+					if (lerRotaAnterior(arquivoRotaAnterior, &rotaAnterior))
+						tspSolver->definirPartidaAquecida(rotaAnterior.data(), (int) rotaAnterior.size(),
+								cidadesAlteradas.data(), (int) cidadesAlteradas.size());
+					else
+						printf("Erro ao abrir arquivo de rota anterior; partida a frio.\n");
+				}
+				rota = tspSolver->resolver();
+				custo = tspSolver->funcaoCustoSolucao(rota);
+				if (tspSolver->obterLimiteInferior() > 0)
+					std::printf("Limite inferior: %.1f (gap %.2f%%)\n", tspSolver->obterLimiteInferior(),
+							100 * (custo / tspSolver->obterLimiteInferior() - 1));
+			}
 
 			std::printf("\nMelhor rota encontrada:\n");
 			for (int i = 0; i < numCidades; i++) {
 				std::printf("%s %d ", (i > 0 ? "," : ""), rota[i] + 1);
 			}
 			std::printf("\n");
-			std::printf("Custo da melhor rota encontrada: %.1f\n", tspSolver->funcaoCustoSolucao(rota));
+			std::printf("Custo da melhor rota encontrada: %.1f\n", custo);
 		} else {
 			printf("Erro ao abrir arquivo de instância.\n");
 		}
 	} else {
-		printf("Este programa requer dois parâmetros:\n - o arquivo de instância;\n - o método de busca local, greedy ou fls (fast local search).\n");
+		printf("Este programa requer os parâmetros:\n - lambda (-1 para calcular);\n - o arquivo de instância;\n - o método de busca local (BLC, BLRAle, BLRMen, BLRMai ou BLRAlfa);\n - o número de iterações;\n - opcionalmente, a semente do gerador aleatório;\n - opcionalmente, o gap (%%) em relação ao limite inferior para interromper a busca (0 desativa);\n - opcionalmente, a metaheurística (GLS, ILS, GLSChute ou DEC).\nOpções (em qualquer posição):\n --checkpoint=arquivo grava o estado da busca periodicamente;\n --intervalo=N iterações entre checkpoints (padrão 1000);\n --retomar=arquivo continua a busca a partir de um checkpoint;\n --threads=N threads da decomposição espacial (padrão: número de núcleos);\n --rota-anterior=arquivo partida aquecida a partir da rota de uma execução anterior (0 marca cidade removida);\n --alteradas=c1,c2,... cidades cujos pesos mudaram desde a execução anterior.\n");
 	}
 
 	std::cout << "Tempo de execução: " << get_cpu_time() << std::endl;
+	std::cout << "Tempo de relógio: " << get_wall_time() - inicioRelogio << std::endl;
 
 	std::cout << "Fim da execução." << std::endl;
 }